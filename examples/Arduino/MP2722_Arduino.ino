@@ -14,6 +14,24 @@ MP2722 pmic;
 // Declare a PowerStatus struct to hold the readout
 PowerStatus status{};
 
+// MP2722 INT pin (open-drain, needs a pull-up), must be interrupt-capable
+static const uint8_t PMIC_INT_PIN = 2;
+
+void pmicInterrupt()
+{
+    pmic.onInterrupt(millis()); // ISR-safe, just queues the pulse
+}
+
+void pmicEvents(uint32_t events, const PowerStatus &status, void *user)
+{
+    if (events & MP2722_EVT_VIN_GD)
+        Serial.println(status.vin_good ? "Input connected." : "Input removed.");
+    if (events & MP2722_EVT_CHG_DONE)
+        Serial.println("Charger Status: Charge Done!");
+    if (events & (MP2722_EVT_CHG_FAULT | MP2722_EVT_BOOST_FAULT | MP2722_EVT_NTC_FAULT))
+        Serial.println("Fault status changed.");
+}
+
 void setup()
 {
     /*
@@ -38,11 +56,24 @@ void setup()
     pmic.setChargeVoltage(4200); // mV = 4.2V @ CV (Constant Voltage) Phase - Basic config
     pmic.setChargeCurrent(1000); // mA = 1A @ CC (Constant Current) Phase - Basic config
     pmic.setCharging(true);      // Enable charger (off by default as basic config is required)
+
+    // React to status changes as they happen instead of polling for them
+    pmic.setEventCallback(pmicEvents);
+    pinMode(PMIC_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(PMIC_INT_PIN), pmicInterrupt, FALLING);
 }
 
 void loop()
 {
-    // Call from main app loop at some interval to continuously monitor status/faults, etc.
+    // Handle queued INT pulses (one status read per burst, nothing if there were none)
+    pmic.service();
+
+    // Fallback: poll status/faults at a slow interval in case an INT pulse is missed
+    static unsigned long last_poll = 0;
+    if (millis() - last_poll < 10000)
+        return;
+    last_poll = millis();
+
     // Returns MP2722_Result::OK on success and other MP2722_Result on failure
     pmic.getStatus(status);
 
@@ -65,7 +96,4 @@ void loop()
 
     // Kick the watchdog to prevent it from resetting the device (if enabled, which it is by default)
     pmic.watchdogKick(); // Watchdog is a heartbeat to let the PMIC know the system is still alive.
-
-    // delay for 1 second interval
-    delay(1000);
 }
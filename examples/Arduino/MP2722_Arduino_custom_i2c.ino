@@ -6,24 +6,27 @@
 
 #include "MP2722.h"
 
-int arduino_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+// ctx is the TwoWire bus given in MP2722_I2C::ctx below
+int arduino_i2c_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
 {
-    Wire.beginTransmission(addr);
-    Wire.write(reg);
-    Wire.write(data, len);
-    return Wire.endTransmission() == 0 ? 0 : -1;
+    TwoWire *wire = (TwoWire *)ctx;
+    wire->beginTransmission(addr);
+    wire->write(reg);
+    wire->write(data, len);
+    return wire->endTransmission() == 0 ? 0 : -1;
 }
 
-int arduino_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int arduino_i2c_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
 {
-    Wire.beginTransmission(addr);
-    Wire.write(reg);
-    if (Wire.endTransmission(false) != 0)
+    TwoWire *wire = (TwoWire *)ctx;
+    wire->beginTransmission(addr);
+    wire->write(reg);
+    if (wire->endTransmission(false) != 0)
         return -1;
-    if (Wire.requestFrom(addr, (uint8_t)len) != len)
+    if (wire->requestFrom(addr, (uint8_t)len) != len)
         return -1;
     for (size_t i = 0; i < len; i++)
-        data[i] = Wire.read();
+        data[i] = wire->read();
     return 0;
 }
 
@@ -33,7 +36,7 @@ void arduino_log(MP2722_LogLevel level, const char *msg)
     Serial.println(msg);
 }
 
-MP2722_I2C i2c = {arduino_i2c_write, arduino_i2c_read};
+MP2722_I2C i2c = {arduino_i2c_write, arduino_i2c_read, &Wire};
 MP2722 pmic(i2c);
 
 void setup()
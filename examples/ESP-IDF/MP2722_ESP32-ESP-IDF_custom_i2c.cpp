@@ -12,17 +12,18 @@ static i2c_master_dev_handle_t dev_handle;
 
 /// --- Custom I2C ---
 
-int espidf_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+// ctx is the device handle given in MP2722_I2C::ctx, so one pair of functions serves every charger
+int espidf_i2c_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
 {
     uint8_t buf[len + 1];
     buf[0] = reg;
     memcpy(&buf[1], data, len);
-    return i2c_master_transmit(dev_handle, buf, len + 1, -1) == ESP_OK ? 0 : -1;
+    return i2c_master_transmit((i2c_master_dev_handle_t)ctx, buf, len + 1, -1) == ESP_OK ? 0 : -1;
 }
 
-int espidf_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int espidf_i2c_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
 {
-    return i2c_master_transmit_receive(dev_handle, &reg, 1, data, len, -1) == ESP_OK ? 0 : -1;
+    return i2c_master_transmit_receive((i2c_master_dev_handle_t)ctx, &reg, 1, data, len, -1) == ESP_OK ? 0 : -1;
 }
 
 /// --- Custom logger ---
@@ -54,7 +55,7 @@ void espidf_log(MP2722_LogLevel level, const char *msg)
 // Pass the custom I2C to the driver constructor
 // It can now be created globally because we already gave the custom I2C functions access to the handles
 // But you can still use a pointer if you need or prefer
-MP2722 pmic({espidf_i2c_write, espidf_i2c_read});
+MP2722 pmic({espidf_i2c_write, espidf_i2c_read, dev_handle});
 
 // Pass the custom logger to the driver log callback
 pmic.setLogCallback(MP2722_LogLevel::DEBUG, {espidf_log});
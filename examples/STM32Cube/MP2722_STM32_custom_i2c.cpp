@@ -11,21 +11,22 @@ extern UART_HandleTypeDef huart2; // for logging via UART
 
 /// --- Custom I2C ---
 
-int stm32_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+// ctx is the I2C peripheral handle given in MP2722_I2C::ctx
+int stm32_i2c_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
 {
     // HAL expects 8-bit (left-shifted) address
     uint16_t dev_addr = (uint16_t)addr << 1;
     HAL_StatusTypeDef ret = HAL_I2C_Mem_Write(
-        &hi2c1, dev_addr, reg, I2C_MEMADD_SIZE_8BIT,
+        (I2C_HandleTypeDef *)ctx, dev_addr, reg, I2C_MEMADD_SIZE_8BIT,
         (uint8_t *)data, len, HAL_MAX_DELAY);
     return (ret == HAL_OK) ? 0 : -1;
 }
 
-int stm32_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int stm32_i2c_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
 {
     uint16_t dev_addr = (uint16_t)addr << 1;
     HAL_StatusTypeDef ret = HAL_I2C_Mem_Read(
-        &hi2c1, dev_addr, reg, I2C_MEMADD_SIZE_8BIT,
+        (I2C_HandleTypeDef *)ctx, dev_addr, reg, I2C_MEMADD_SIZE_8BIT,
         data, len, HAL_MAX_DELAY);
     return (ret == HAL_OK) ? 0 : -1;
 }
@@ -64,7 +65,7 @@ void stm32_log(MP2722_LogLevel level, const char *msg)
 // Pass the custom I2C to the driver constructor
 // It can now be created globally because we already gave the custom I2C functions access to the handles
 // But you can still use a pointer if you need or prefer
-MP2722 pmic({stm32_i2c_write, stm32_i2c_read});
+MP2722 pmic({stm32_i2c_write, stm32_i2c_read, &hi2c1});
 
 // Pass the custom logger to the driver log callback
 pmic.setLogCallback(MP2722_LogLevel::DEBUG, {stm32_log});
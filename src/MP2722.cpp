@@ -1,5 +1,96 @@
 #include "MP2722.h"
 
+#include <string.h>
+
+using namespace MP2722_Fields;
+
+// Log calls above MP2722_LOG_MAX_LEVEL expand to nothing, so neither the call nor its format string is compiled in.
+// Arguments must be int-sized (promoted char/short/int, %d %u %x %X %c): deferred records store them as int.
+#define MP2722_LOG_ARGC_(fmt, a1, a2, a3, a4, a5, a6, n, ...) n
+#define MP2722_LOG_ARGC(...) MP2722_LOG_ARGC_(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, 0)
+#define MP2722_LOG(level, ...) log(MP2722_LogLevel::level, MP2722_LOG_ARGC(__VA_ARGS__), __VA_ARGS__)
+
+#if MP2722_LOG_MAX_LEVEL >= MP2722_LOG_LEVEL_ERROR
+#define MP2722_LOGE(...) MP2722_LOG(ERROR, __VA_ARGS__)
+#else
+#define MP2722_LOGE(...) ((void)0)
+#endif
+#if MP2722_LOG_MAX_LEVEL >= MP2722_LOG_LEVEL_WARN
+#define MP2722_LOGW(...) MP2722_LOG(WARN, __VA_ARGS__)
+#else
+#define MP2722_LOGW(...) ((void)0)
+#endif
+#if MP2722_LOG_MAX_LEVEL >= MP2722_LOG_LEVEL_INFO
+#define MP2722_LOGI(...) MP2722_LOG(INFO, __VA_ARGS__)
+#else
+#define MP2722_LOGI(...) ((void)0)
+#endif
+#if MP2722_LOG_MAX_LEVEL >= MP2722_LOG_LEVEL_DEBUG
+#define MP2722_LOGD(...) MP2722_LOG(DEBUG, __VA_ARGS__)
+#else
+#define MP2722_LOGD(...) ((void)0)
+#endif
+
+// Bits the PMIC clears by itself after being written to 1. They are never kept in the register cache.
+static uint8_t selfClearingBits(uint8_t reg)
+{
+    return MP2722_Config::actionBits(reg);
+}
+
+// Largest run of unchanged registers a Transaction rewrites to merge two burst writes into one. Rewriting a byte costs
+// less wire time than the device address + register address + START/STOP of an extra transaction.
+static const uint8_t MAX_MERGE_GAP = 2;
+
+// Find the next burst write of a Transaction starting at or after `from`: a run of dirty registers, extended over gaps
+// of up to MAX_MERGE_GAP registers whose value is known. Returns false when no dirty register is left.
+static bool findRun(uint32_t dirty, uint32_t known, uint8_t from, uint8_t &start, uint8_t &len)
+{
+    uint8_t reg = from;
+    while (reg < MP2722_CONFIG_REG_COUNT && !(dirty & (1UL << reg)))
+        reg++;
+    if (reg >= MP2722_CONFIG_REG_COUNT)
+        return false;
+
+    start = reg;
+    uint8_t end = reg;
+    for (uint8_t next = end + 1; next < MP2722_CONFIG_REG_COUNT; next++)
+    {
+        if (!(dirty & (1UL << next)))
+            continue;
+        bool gap_known = true;
+        for (uint8_t gap = end + 1; gap < next; gap++)
+            gap_known = gap_known && (known & (1UL << gap));
+        if (next - end - 1 > MAX_MERGE_GAP || !gap_known)
+            break;
+        end = next;
+    }
+
+    len = end - start + 1;
+    return true;
+}
+
+// Configuration registers also written by the PMIC itself (IIN_LIM is updated after input source detection)
+static bool isVolatileReg(uint8_t reg)
+{
+    return reg == MP2722_REG_CONFIG1;
+}
+
+// Register tables generated from docs/REG_MAP_CONFIG.csv and docs/REG_MAP_STATUS.csv (see MP2722_regmap.h)
+static const uint8_t watchdogResetBits[MP2722_CONFIG_REG_COUNT] = {MP2722_WTD_RESET_BITS};
+static const uint8_t writableBits[MP2722_REG_COUNT] = {MP2722_WRITABLE_BITS};
+
+struct FieldInfo
+{
+    const char *name;
+    uint8_t reg;
+    uint8_t mask;
+    uint8_t shift;
+};
+
+#define MP2722_FIELD_INFO(name, reg, mask, shift) {#name, reg, mask, shift},
+static const FieldInfo fieldInfo[] = {MP2722_REG_FIELD_LIST(MP2722_FIELD_INFO)};
+#undef MP2722_FIELD_INFO
+
 MP2722::MP2722(const MP2722_I2C &i2c, uint8_t address)
     : _i2c(i2c), _address(address)
 {
@@ -34,36 +125,224 @@ void MP2722::setLogCallback(MP2722_LogLevel level, MP2722_LogCallback callback)
     _logCallback = callback;
 }
 
-void MP2722::log(MP2722_LogLevel level, const char *fmt, ...)
+void MP2722::log(MP2722_LogLevel level, uint8_t argc, const char *fmt, ...)
 {
     if (!_logCallback || level > _logLevel || level == MP2722_LogLevel::NONE)
         return;
 
-    char buf[128];
+    LogRecord record = {};
+    record.fmt = fmt;
+    record.level = level;
     va_list args;
     va_start(args, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, args);
+    for (uint8_t i = 0; i < argc && i < MP2722_LOG_MAX_ARGS; i++)
+        record.args[i] = va_arg(args, int);
     va_end(args);
 
-    _logCallback(level, buf);
+#if MP2722_LOG_DEFER_SIZE > 0
+    if (!_logQueue.push(record))
+        _logDropped++;
+#else
+    emitLog(record);
+#endif
 }
 
-MP2722_Result MP2722::writeReg(uint8_t reg, uint8_t val)
+void MP2722::emitLog(const LogRecord &record) const
+{
+    const int *a = record.args;
+    char buf[128];
+    snprintf(buf, sizeof(buf), record.fmt, a[0], a[1], a[2], a[3], a[4], a[5]);
+    _logCallback(record.level, buf);
+}
+
+uint8_t MP2722::flushLog(uint8_t max)
+{
+    uint8_t count = 0;
+#if MP2722_LOG_DEFER_SIZE > 0
+    LogRecord record;
+    while (count < max && _logQueue.pop(record))
+    {
+        if (_logCallback)
+            emitLog(record);
+        count++;
+    }
+#else
+    (void)max;
+#endif
+    return count;
+}
+
+void MP2722::setRegisterCache(bool enable)
 {
-    if (!_i2c.write)
+    _cacheEnabled = enable;
+}
+
+MP2722_Result MP2722::syncRegisterCache()
+{
+    Guard guard(*this);
+    uint8_t buf[MP2722_CONFIG_REG_COUNT];
+    // readRegs() refreshes the cache with whatever it reads back
+    return readRegs(MP2722_REG_CONFIG0, buf, MP2722_CONFIG_REG_COUNT);
+}
+
+void MP2722::updateShadow(uint8_t start_reg, const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        size_t reg = start_reg + i;
+        if (reg >= MP2722_CONFIG_REG_COUNT)
+            break;
+        _shadow[reg] = buf[i] & ~selfClearingBits(reg);
+    }
+}
+
+bool MP2722::isCached(uint8_t reg) const
+{
+    return _cacheEnabled && _shadowValid && reg < MP2722_CONFIG_REG_COUNT && !isVolatileReg(reg);
+}
+
+uint32_t MP2722::cachedRegs() const
+{
+    uint32_t regs = 0;
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+    {
+        if (isCached(reg))
+            regs |= 1UL << reg;
+    }
+    return regs;
+}
+
+void MP2722::onRegsRead(uint8_t start_reg, const uint8_t *buf, size_t len)
+{
+    if (start_reg >= MP2722_CONFIG_REG_COUNT)
+        return;
+
+    updateShadow(start_reg, buf, len);
+    bool full = start_reg == MP2722_REG_CONFIG0 && len >= MP2722_CONFIG_REG_COUNT;
+    if (full)
+        _shadowValid = true;
+
+    // The first full read is the baseline of the applied configuration, later reads only refresh what the PMIC
+    // changes by itself
+    for (size_t i = 0; i < len && start_reg + i < MP2722_CONFIG_REG_COUNT; i++)
+    {
+        uint8_t reg = start_reg + i;
+        if ((full && !_appliedValid) || isVolatileReg(reg))
+            _applied[reg] = buf[i] & ~selfClearingBits(reg);
+    }
+    if (full)
+        _appliedValid = true;
+}
+
+void MP2722::onRegsWritten(uint8_t start_reg, const uint8_t *buf, size_t len, bool ok)
+{
+    if (!ok)
+    {
+        // The registers may or may not have been written, so the cache can no longer be trusted
+        _shadowValid = false;
+        _shadowValidAtFault = false;
+        return;
+    }
+
+    updateShadow(start_reg, buf, len);
+    for (size_t i = 0; i < len && start_reg + i < MP2722_CONFIG_REG_COUNT; i++)
+        _applied[start_reg + i] = buf[i] & ~selfClearingBits(start_reg + i);
+
+    // A register reset brings every configuration register back to its default value
+    if (start_reg == MP2722_REG_CONFIG0 && (buf[0] & MP2722_REG_RST_MASK))
+    {
+        _shadowValid = false;
+        _shadowValidAtFault = false;
+        _appliedValid = false;
+    }
+
+    if (start_reg <= MP2722_REG_CONFIG7 && start_reg + len > MP2722_REG_CONFIG7 &&
+        (buf[MP2722_REG_CONFIG7 - start_reg] & WATCHDOG_RST::mask))
+    {
+        _kicked = true;
+        _lastKickMs = now();
+    }
+}
+
+MP2722_Result MP2722::writeRegs(uint8_t start_reg, const uint8_t *buf, size_t len)
+{
+    if (!_i2c.write || isBusy())
         return MP2722_Result::INVALID_STATE;
 
-    int ret = _i2c.write(_address, reg, &val, 1);
+    // A write covering CONFIG7h kicks the watchdog for free
+    uint8_t kicked[MP2722_CONFIG_REG_COUNT];
+    bool kick = _initialized && start_reg <= MP2722_REG_CONFIG7 && start_reg + len > MP2722_REG_CONFIG7 &&
+                len <= sizeof(kicked) && watchdogEnabled();
+    if (kick)
+    {
+        memcpy(kicked, buf, len);
+        kicked[MP2722_REG_CONFIG7 - start_reg] |= WATCHDOG_RST::mask;
+        buf = kicked;
+    }
+
+    // Writing an action bit twice could act twice (e.g. a second reset after a NAK that came too late)
+    bool idempotent = true;
+    for (size_t i = 0; i < len; i++)
+        if (buf[i] & selfClearingBits(start_reg + i) & ~WATCHDOG_RST::mask)
+            idempotent = false;
+
+    int ret = transfer(true, start_reg, const_cast<uint8_t *>(buf), len, idempotent);
+    onRegsWritten(start_reg, buf, len, ret == 0);
     return (ret == 0) ? MP2722_Result::OK : MP2722_Result::FAIL;
 }
 
+MP2722_Result MP2722::writeReg(uint8_t reg, uint8_t val)
+{
+    return writeRegs(reg, &val, 1);
+}
+
 MP2722_Result MP2722::readRegs(uint8_t start_reg, uint8_t *buf, size_t len)
 {
-    if (!_i2c.read)
+    if (!_i2c.read || isBusy())
         return MP2722_Result::INVALID_STATE;
 
-    int ret = _i2c.read(_address, start_reg, buf, len);
-    return (ret == 0) ? MP2722_Result::OK : MP2722_Result::FAIL;
+    int ret = transfer(false, start_reg, buf, len, true);
+    if (ret != 0)
+        return MP2722_Result::FAIL;
+
+    onRegsRead(start_reg, buf, len);
+    return MP2722_Result::OK;
+}
+
+void MP2722::recordTransfer(bool write, int result, size_t len, uint32_t ticks)
+{
+    if (!_stats)
+        return;
+    MP2722_BusOpStats &op = write ? _stats->write : _stats->read;
+    op.record(result, len, ticks, _statsTimer != nullptr);
+}
+
+// One transfer, attempted again per the retry policy if `retry`. Returns the platform code of the last attempt.
+int MP2722::transfer(bool write, uint8_t start_reg, uint8_t *buf, size_t len, bool retry)
+{
+    const uint32_t first = now();
+    uint32_t waited = 0;
+    uint32_t backoff = _retry.backoff_ms;
+    for (uint8_t attempt = 1;; attempt++)
+    {
+        uint32_t started = busTime();
+        int ret = write ? _i2c.write(_i2c.ctx, _address, start_reg, buf, len)
+                        : _i2c.read(_i2c.ctx, _address, start_reg, buf, len);
+        recordTransfer(write, ret, len, busTime() - started);
+        if (ret == 0 || !retry || attempt >= _retry.max_attempts)
+            return ret;
+
+        uint32_t spent = _clock ? now() - first : waited;
+        if (_retry.budget_ms && spent + backoff > _retry.budget_ms)
+            return ret;
+
+        if (_stats)
+            _stats->retries++;
+        if (backoff && _retry.delay_ms)
+            _retry.delay_ms(backoff);
+        waited += backoff;
+        backoff = (backoff * 2 < _retry.max_backoff_ms) ? backoff * 2 : _retry.max_backoff_ms;
+    }
 }
 
 MP2722_Result MP2722::readReg(uint8_t reg, uint8_t &val)
@@ -73,53 +352,169 @@ MP2722_Result MP2722::readReg(uint8_t reg, uint8_t &val)
 
 MP2722_Result MP2722::updateReg(uint8_t reg, uint8_t mask, uint8_t val)
 {
+    MP2722_Result ret;
+    if (_cacheEnabled && !_shadowValid && reg < MP2722_CONFIG_REG_COUNT)
+    {
+        ret = syncRegisterCache();
+        if (ret != MP2722_Result::OK)
+            return ret;
+    }
+
     uint8_t old_val;
-    MP2722_Result ret = readReg(reg, old_val);
-    if (ret != MP2722_Result::OK)
-        return ret;
+    if (isCached(reg))
+    {
+        old_val = _shadow[reg];
+    }
+    else
+    {
+        ret = readReg(reg, old_val);
+        if (ret != MP2722_Result::OK)
+            return ret;
+    }
 
     uint8_t new_val = (old_val & ~mask) | (val & mask);
     if (new_val != old_val)
         return writeReg(reg, new_val);
 
+    if (_stats)
+        _stats->writesAvoided++;
     return MP2722_Result::OK;
 }
 
-MP2722_Result MP2722::init()
+MP2722::Transaction MP2722::beginTransaction()
 {
-    // Check I2C is available before any hardware access
-    if (!_i2c.write || !_i2c.read)
+    return Transaction(*this);
+}
+
+MP2722_Result MP2722::Transaction::load()
+{
+    Guard guard(_dev);
+    MP2722_Result ret = _dev.syncRegisterCache();
+    if (ret == MP2722_Result::OK)
+        _fresh = (1UL << MP2722_CONFIG_REG_COUNT) - 1;
+    return ret;
+}
+
+MP2722::Transaction &MP2722::Transaction::update(uint8_t reg, uint8_t mask, uint8_t val)
+{
+    if (reg >= MP2722_CONFIG_REG_COUNT)
     {
-        log(MP2722_LogLevel::ERROR, "No built-in platform preset nor custom interface was provided. "
-                                    "If this is an unsupported platform, you need to provide your own "
-                                    "I2C read/write function wrappers in the constructor, and if the platform"
-                                    "uses I2C handle, set it up with mp2722_platform_set_i2c_handle(). "
-                                    "See documentation and examples for details.");
-        return MP2722_Result::FAIL;
+        _invalid = true;
+        return *this;
     }
 
-    // Probe registers to verify connection
-    uint8_t val;
-    MP2722_Result ret = readReg(MP2722_REG_CONFIG0, val);
-    if (ret != MP2722_Result::OK)
+    _value[reg] = (_value[reg] & ~mask) | (val & mask);
+    _mask[reg] |= mask;
+    return *this;
+}
+
+uint32_t MP2722::Transaction::staged() const
+{
+    uint32_t regs = 0;
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
     {
-        log(MP2722_LogLevel::ERROR, "Failed to communicate with MP2722");
-        return ret;
+        if (_mask[reg])
+            regs |= 1UL << reg;
     }
+    return regs;
+}
 
-    _initialized = true;
+uint32_t MP2722::Transaction::buildImage(uint8_t *image)
+{
+    // The shadow copy holds the base value of every known register (fresh or cached)
+    uint32_t dirty = 0;
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+    {
+        image[reg] = _dev._shadow[reg];
+        if (!_mask[reg])
+            continue;
+        image[reg] = (image[reg] & ~_mask[reg]) | _value[reg];
+        if (image[reg] != _dev._shadow[reg])
+            dirty |= 1UL << reg;
+        else if (_dev._stats)
+            _dev._stats->writesAvoided++;
+    }
+
+    // Staging is consumed whatever the outcome
+    memset(_mask, 0, sizeof(_mask));
+    memset(_value, 0, sizeof(_value));
+    return dirty;
+}
+
+MP2722_Result MP2722::Transaction::commit()
+{
+    Guard guard(_dev);
+    MP2722_Result ret = _invalid ? MP2722_Result::INVALID_ARG : apply();
+
+    // Reused for a new batch: values read for this one may be outdated by then
+    memset(_mask, 0, sizeof(_mask));
+    memset(_value, 0, sizeof(_value));
+    _fresh = 0;
+    _invalid = false;
+    return ret;
+}
+
+MP2722_Result MP2722::Transaction::apply()
+{
+    uint32_t staged_regs = staged();
+    if (!staged_regs)
+        return MP2722_Result::OK;
+
+    // Fetch the base value of every staged register we don't already know, in a single burst read
+    uint32_t known = _fresh | _dev.cachedRegs();
+    uint32_t missing = staged_regs & ~known;
+    if (missing)
+    {
+        MP2722_Result ret;
+        if (_dev._cacheEnabled && !_dev._shadowValid)
+        {
+            ret = load();
+        }
+        else
+        {
+            uint8_t first = 0;
+            while (!(missing & (1UL << first)))
+                first++;
+            uint8_t last = MP2722_CONFIG_REG_COUNT - 1;
+            while (!(missing & (1UL << last)))
+                last--;
+
+            uint8_t buf[MP2722_CONFIG_REG_COUNT];
+            ret = _dev.readRegs(first, buf, last - first + 1);
+            if (ret == MP2722_Result::OK)
+            {
+                for (uint8_t reg = first; reg <= last; reg++)
+                    _fresh |= 1UL << reg;
+            }
+        }
+        if (ret != MP2722_Result::OK)
+            return ret;
+        known = _fresh | _dev.cachedRegs();
+    }
+
+    uint8_t image[MP2722_CONFIG_REG_COUNT];
+    uint32_t dirty = buildImage(image);
+
+    uint8_t start, len;
+    uint8_t from = 0;
+    while (findRun(dirty, known, from, start, len))
+    {
+        MP2722_Result ret = _dev.writeRegs(start, &image[start], len);
+        if (ret != MP2722_Result::OK)
+            return ret;
+        from = start + len;
+    }
+
+    return MP2722_Result::OK;
+}
 
+void MP2722::stageInitDefaults(Transaction &tx)
+{
     // If these bits are not 000, PMIC will set a fixed limit and ignore values defined from setInputCurrentLimit()
     // or from input source detection. So we ensure it is set to 000 by default.
     // CONFIG1 bits [7:5] - set IIN_MODE to 000 (Follow IIN_LIM)
-    uint8_t mode = 0 << MP2722_IIN_MODE_SHIFT;
-    ret = updateReg(MP2722_REG_CONFIG1, MP2722_IIN_MODE_MASK, mode);
-    if (ret != MP2722_Result::OK)
-    {
-        _initialized = false;
-        log(MP2722_LogLevel::ERROR, "Failed to set IIN_MODE to Follow IIN_LIM");
-        return ret;
-    }
+    tx.set<IIN_MODE>(0);
+
     // SAFETY CRITICAL:
     // Driver initial state DISABLES Charging by default, as charge parameters must be explicitly adjusted to any
     // specific battery first. Higher current and voltage limits than what the battery can handle will likely
@@ -128,73 +523,152 @@ MP2722_Result MP2722::init()
     // Also, depending on application or if the battery is removable, it might happen that the system is powered
     // via VBUS with no battery connected, so by not starting charging by default, we are ensuring that the power
     // path control logic has to be explicitly handled according to the specific needs of the application.
-    ret = setCharging(false);
-    if (ret != MP2722_Result::OK)
+    tx.set<EN_CHG>(false);
+
+    // Auto D+/D- Detection, Buck Converter, Auto OTG and Boost Stop on Battery Low
+    tx.set<AUTODPDM>(true).set<EN_BUCK>(true).set<AUTOOTG>(true).set<BOOST_STP_EN>(true);
+}
+
+MP2722_Result MP2722::init()
+{
+    Guard guard(*this);
+    // Check I2C is available before any hardware access
+    if (!_i2c.write || !_i2c.read)
     {
-        _initialized = false;
-        log(MP2722_LogLevel::ERROR, "Failed to disable charging");
-        return ret;
+        MP2722_LOGE("No built-in platform preset nor custom interface was provided. "
+                                    "If this is an unsupported platform, you need to provide your own "
+                                    "I2C read/write function wrappers in the constructor, and if the platform"
+                                    "uses I2C handle, set it up with mp2722_platform_set_i2c_handle(). "
+                                    "See documentation and examples for details.");
+        return MP2722_Result::FAIL;
     }
 
-    ret = setAutoDpDmDetection(true);
+    // Probe registers to verify connection. The whole configuration block is read in one burst, so every default
+    // below is applied from it without further reads.
+    Transaction tx = beginTransaction();
+    MP2722_Result ret = tx.load();
     if (ret != MP2722_Result::OK)
     {
-        _initialized = false;
-        log(MP2722_LogLevel::ERROR, "Failed to enable Auto D+/D- Detection");
+        MP2722_LOGE("Failed to communicate with MP2722");
         return ret;
     }
 
-    ret = setBuck(true);
+    stageInitDefaults(tx);
+    ret = tx.commit();
     if (ret != MP2722_Result::OK)
     {
-        _initialized = false;
-        log(MP2722_LogLevel::ERROR, "Failed to enable Buck Converter");
+        MP2722_LOGE("Failed to apply default configuration");
         return ret;
     }
 
-    ret = setAutoOTG(true);
+    _initialized = true;
+
+    MP2722_LOGI("MP2722 Initialized. CONFIG0=0x%02X", _shadow[MP2722_REG_CONFIG0]);
+    return MP2722_Result::OK;
+}
+
+MP2722_Result MP2722::reset()
+{
+    Guard guard(*this);
+    return updateField<REG_RST>(true);
+}
+
+MP2722_Result MP2722::applyConfig(const MP2722_Config &config, bool verify)
+{
+    Guard guard(*this);
+    const uint8_t *image = config.image();
+    uint8_t buf[MP2722_CONFIG_REG_COUNT];
+    memcpy(buf, image, sizeof(buf));
+
+    // LOCK_CHG would refuse the higher charge settings that follow CONFIG00h in the burst, so it is set last
+    bool lock = LOCK_CHG::decode(buf[MP2722_REG_CONFIG0]);
+    buf[MP2722_REG_CONFIG0] &= ~LOCK_CHG::mask;
+
+    MP2722_Result ret = writeRegs(MP2722_REG_CONFIG0, buf, sizeof(buf));
+    if (ret == MP2722_Result::OK && lock)
+        ret = writeReg(MP2722_REG_CONFIG0, image[MP2722_REG_CONFIG0]);
     if (ret != MP2722_Result::OK)
     {
-        _initialized = false;
-        log(MP2722_LogLevel::ERROR, "Failed to enable Auto OTG");
+        MP2722_LOGE("Failed to write configuration");
         return ret;
     }
+    if (!verify)
+        return MP2722_Result::OK;
 
-    ret = setBoostStopOnBattLow(true);
+    ret = readRegs(MP2722_REG_CONFIG0, buf, sizeof(buf));
     if (ret != MP2722_Result::OK)
-    {
-        _initialized = false;
-        log(MP2722_LogLevel::ERROR, "Failed to enable Boost Stop on Battery Low");
         return ret;
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+    {
+        if ((buf[reg] ^ image[reg]) & ~selfClearingBits(reg))
+        {
+            MP2722_LOGE("Configuration mismatch at REG%02Xh: wrote 0x%02X, read 0x%02X", reg, image[reg], buf[reg]);
+            return MP2722_Result::FAIL;
+        }
     }
+    return MP2722_Result::OK;
+}
 
-    log(MP2722_LogLevel::INFO, "MP2722 Initialized. CONFIG0=0x%02X", val);
+MP2722_Result MP2722::dumpRegisters(MP2722_RegisterDump &dump)
+{
+    Guard guard(*this);
+    MP2722_Result ret = readRegs(MP2722_REG_CONFIG0, dump.regs, MP2722_REG_COUNT);
+    if (ret != MP2722_Result::OK)
+        return ret;
+
+    onStatusRead(dump.status());
+    recoverConfig();
     return MP2722_Result::OK;
 }
 
-MP2722_Result MP2722::reset()
+MP2722_Result MP2722::restoreConfig(const MP2722_RegisterDump &dump)
+{
+    Guard guard(*this);
+    const uint8_t *regs = dump.regs;
+
+    // Same LOCK_CHG ordering as applyConfig(): unlocking goes with the burst, locking after it
+    bool lock = LOCK_CHG::decode(regs[MP2722_REG_CONFIG0]);
+    Transaction tx = beginTransaction();
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+    {
+        uint8_t mask = writableBits[reg] & ~selfClearingBits(reg);
+        if (reg == MP2722_REG_CONFIG0 && lock)
+            mask &= ~LOCK_CHG::mask;
+        tx.update(reg, mask, regs[reg]);
+    }
+
+    MP2722_Result ret = tx.commit();
+    if (ret == MP2722_Result::OK && lock)
+        ret = updateField<LOCK_CHG>(true);
+    return ret;
+}
+
+uint8_t MP2722_RegisterDump::diff(const MP2722_RegisterDump &other, MP2722_FieldDiffCallback callback, void *user) const
 {
-    return updateReg(MP2722_REG_CONFIG0, MP2722_REG_RST_MASK, MP2722_REG_RST_MASK);
+    uint8_t count = 0;
+    for (const FieldInfo &field : fieldInfo)
+    {
+        uint8_t from = regs[field.reg] & field.mask;
+        uint8_t to = other.regs[field.reg] & field.mask;
+        if (from == to)
+            continue;
+        count++;
+        if (callback)
+            callback(field.name, field.reg, from >> field.shift, to >> field.shift, user);
+    }
+    return count;
 }
 
-MP2722_Result MP2722::setChargeCurrent(uint16_t current_ma)
+MP2722_Result MP2722::writeChargeCurrent(uint8_t icc)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    if (current_ma < 80)
-        current_ma = 80;
-    if (current_ma > 5000)
-        current_ma = 5000;
-
-    uint8_t steps = current_ma / MP2722_ICC_STEP;
-    if (steps > 0x3F)
-        steps = 0x3F;
-
-    MP2722_Result ret = updateReg(MP2722_REG_CONFIG2, MP2722_ICC_MASK, steps);
+    MP2722_Result ret = updateReg(ICC::reg, ICC::mask, icc);
     if (ret != MP2722_Result::OK)
     {
         _isChargeCurrentSet = false;
@@ -202,30 +676,20 @@ MP2722_Result MP2722::setChargeCurrent(uint16_t current_ma)
     }
 
     _isChargeCurrentSet = true;
-    log(MP2722_LogLevel::DEBUG, "Set Charge Current: %dmA (0x%02X)", current_ma, steps);
+    MP2722_LOGD("Set Charge Current: %dmA (0x%02X)", ICC::decode(icc), ICC::get(icc));
     return ret;
 }
 
-MP2722_Result MP2722::setChargeVoltage(uint16_t voltage_mv)
+MP2722_Result MP2722::writeChargeVoltage(uint8_t vbatt)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    if (voltage_mv < 3600)
-        voltage_mv = 3600;
-    if (voltage_mv > 4600)
-        voltage_mv = 4600;
-
-    uint8_t steps = (voltage_mv - MP2722_VBATT_REG_BASE) / MP2722_VBATT_REG_STEP;
-    if (steps > 0x3F)
-        steps = 0x3F;
-
-    uint8_t reg_val = steps << MP2722_VBATT_REG_SHIFT;
-
-    MP2722_Result ret = updateReg(MP2722_REG_CONFIG5, MP2722_VBATT_REG_MASK, reg_val);
+    MP2722_Result ret = updateReg(VBATT_REG::reg, VBATT_REG::mask, vbatt);
     if (ret != MP2722_Result::OK)
     {
         _isChargeVoltageSet = false;
@@ -233,217 +697,910 @@ MP2722_Result MP2722::setChargeVoltage(uint16_t voltage_mv)
     }
 
     _isChargeVoltageSet = true;
-    log(MP2722_LogLevel::DEBUG, "Set Charge Voltage: %dmV (0x%02X)", voltage_mv, steps);
+    MP2722_LOGD("Set Charge Voltage: %dmV (0x%02X)", VBATT_REG::decode(vbatt), VBATT_REG::get(vbatt));
     return ret;
 }
 
-MP2722_Result MP2722::setInputCurrentLimit(uint16_t current_ma)
+MP2722_Result MP2722::writeInputCurrentLimit(uint8_t iin_lim)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    if (current_ma < 100)
-        current_ma = 100;
-    if (current_ma > 3200)
-        current_ma = 3200;
-
-    uint8_t steps = (current_ma - MP2722_IIN_LIM_BASE) / MP2722_IIN_LIM_STEP;
-    if (steps > 0x1F)
-        steps = 0x1F;
-
-    log(MP2722_LogLevel::DEBUG, "Set Input Limit: %dmA (0x%02X)", current_ma, steps);
-    return updateReg(MP2722_REG_CONFIG1, MP2722_IIN_LIM_MASK, steps);
+    MP2722_LOGD("Set Input Limit: %dmA (0x%02X)", IIN_LIM::decode(iin_lim), IIN_LIM::get(iin_lim));
+    return updateReg(IIN_LIM::reg, IIN_LIM::mask, iin_lim);
 }
 
 MP2722_Result MP2722::forceDpDmDetection()
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    return updateReg(MP2722_REG_CONFIGA, MP2722_FORCEDPDM_MASK, MP2722_FORCEDPDM_MASK);
+    return updateField<FORCEDPDM>(true);
 }
 
 MP2722_Result MP2722::setAutoDpDmDetection(bool enable)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_AUTODPDM_MASK : 0;
-    return updateReg(MP2722_REG_CONFIGA, MP2722_AUTODPDM_MASK, val);
+    return updateField<AUTODPDM>(enable);
 }
 
 MP2722_Result MP2722::setCharging(bool enable)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    if (enable && (!_isChargeVoltageSet || !_isChargeCurrentSet))
+    if (enable && !chargeSetpointsValid())
     {
-        log(MP2722_LogLevel::ERROR, "Charge FAULT: Voltage and Current must be adjusted first!");
+        MP2722_LOGE("Charge FAULT: Voltage and Current must be adjusted first!");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_EN_CHG_MASK : 0;
-    return updateReg(MP2722_REG_CONFIG9, MP2722_EN_CHG_MASK, val);
+    return updateField<EN_CHG>(enable);
 }
 
 MP2722_Result MP2722::setBuck(bool enable)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_EN_BUCK_MASK : 0;
-    return updateReg(MP2722_REG_CONFIG9, MP2722_EN_BUCK_MASK, val);
+    return updateField<EN_BUCK>(enable);
 }
 
 MP2722_Result MP2722::setBoost(bool enable)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_EN_BOOST_MASK : 0;
-    return updateReg(MP2722_REG_CONFIG9, MP2722_EN_BOOST_MASK, val);
+    return updateField<EN_BOOST>(enable);
 }
 
 MP2722_Result MP2722::setBoostStopOnBattLow(bool enable)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_BOOST_STP_EN_MASK : 0;
-    return updateReg(MP2722_REG_CONFIGC, MP2722_BOOST_STP_EN_MASK, val);
+    return updateField<BOOST_STP_EN>(enable);
 }
 
 MP2722_Result MP2722::setAutoOTG(bool enable)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_AUTOOTG_MASK : 0;
-    return updateReg(MP2722_REG_CONFIG9, MP2722_AUTOOTG_MASK, val);
+    return updateField<AUTOOTG>(enable);
 }
 
 MP2722_Result MP2722::setStatAsAnalogIB(bool enable, bool charging_only)
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    uint8_t val = enable ? MP2722_EN_STAT_IB_MASK : 0;
-    MP2722_Result ret = updateReg(MP2722_REG_CONFIG0, MP2722_EN_STAT_IB_MASK, val);
+    MP2722_Result ret = updateField<EN_STAT_IB>(enable);
     if (ret != MP2722_Result::OK)
         return ret;
 
-    val = charging_only ? 0 : MP2722_IB_EN_MASK;
-    return updateReg(MP2722_REG_CONFIG7, MP2722_IB_EN_MASK, val);
+    return updateField<IB_EN>(!charging_only);
 }
 
 MP2722_Result MP2722::enterShippingMode()
 {
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    log(MP2722_LogLevel::WARN, "Entering Shipping Mode (BATFET Off)");
-    return updateReg(MP2722_REG_CONFIG8, MP2722_BATTFET_DIS_MASK, MP2722_BATTFET_DIS_MASK);
+    MP2722_LOGW("Entering Shipping Mode (BATFET Off)");
+    return updateField<BATTFET_DIS>(true);
 }
 
 MP2722_Result MP2722::watchdogKick()
 {
+    Guard guard(*this);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    // CONFIG7h only changes through this driver (or a watchdog reset, which invalidates the shadow)
+    if (isCached(MP2722_REG_CONFIG7))
+        return writeReg(MP2722_REG_CONFIG7, _shadow[MP2722_REG_CONFIG7] | WATCHDOG_RST::mask);
+
+    return updateField<WATCHDOG_RST>(true);
+}
+
+MP2722_Result MP2722::setWatchdog(WatchdogTimer period)
+{
+    Guard guard(*this);
     if (!_initialized)
     {
-        log(MP2722_LogLevel::ERROR, "init() must be called first");
+        MP2722_LOGE("init() must be called first");
         return MP2722_Result::INVALID_STATE;
     }
 
-    return updateReg(MP2722_REG_CONFIG7, MP2722_WATCHDOG_RST_MASK, MP2722_WATCHDOG_RST_MASK);
+    uint8_t code = static_cast<uint8_t>(period);
+    MP2722_LOGI("Set Watchdog: %ds (0x%02X)", code ? 20 << code : 0, code);
+    return updateField<WATCHDOG>(code);
+}
+
+uint32_t MP2722::watchdogPeriodMs() const
+{
+    Guard guard(*this, false);
+    // Same rule as watchdogKick(): the shadow only counts while cached, else the POR default (40s, the shortest)
+    uint8_t code = isCached(MP2722_REG_CONFIG7) ? WATCHDOG::get(_shadow[MP2722_REG_CONFIG7])
+                                                : static_cast<uint8_t>(WatchdogTimer::SEC_40);
+    return code ? 20000UL << code : 0;
+}
+
+MP2722_Result MP2722::setChargeTimer(ChargeTimer timer, bool double_in_regulation)
+{
+    Guard guard(*this);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    MP2722_LOGI("Set Charge Timer: %dh (0x%02X), doubled in regulation: %d", static_cast<uint8_t>(timer) * 5,
+                static_cast<uint8_t>(timer), double_in_regulation);
+    return updateReg(MP2722_REG_CONFIG7, CHG_TIMER::mask | EN_TMR2X::mask,
+                     CHG_TIMER::encode(static_cast<uint8_t>(timer)) | EN_TMR2X::encode(double_in_regulation));
+}
+
+MP2722_Result MP2722::getStatus(RawStatus &status)
+{
+    if (freshStatus(status))
+        return MP2722_Result::OK;
+
+    Guard guard(*this);
+    return readStatus(status);
+}
+
+MP2722_Result MP2722::readStatus(RawStatus &status)
+{
+    MP2722_Result ret = readRegs(MP2722_REG_STATUS11, status.regs, MP2722_STATUS_REG_COUNT);
+    if (ret != MP2722_Result::OK)
+        return ret;
+
+    onStatusRead(status);
+    recoverConfig();
+    return MP2722_Result::OK;
+}
+
+bool MP2722::peekStatus(RawStatus &status, uint32_t *age_ms) const
+{
+    MP2722_RecorderEntry entry;
+    if (!_published.load(entry))
+        return false;
+
+    status = entry.status;
+    if (age_ms)
+        *age_ms = now() - entry.timestamp;
+    return true;
+}
+
+// Snapshot served instead of a bus read when it is younger than the max age (needs a clock shared by all threads)
+bool MP2722::freshStatus(RawStatus &status) const
+{
+    if (!_statusMaxAge || !_clock)
+        return false;
+
+    uint32_t age;
+    return peekStatus(status, &age) && age <= _statusMaxAge;
+}
+
+MP2722_Result MP2722::getStatus(uint8_t fields, RawStatus &status)
+{
+    fields &= MP2722_STATUS_ALL;
+    if (!fields)
+        return MP2722_Result::INVALID_ARG;
+    if (freshStatus(status))
+        return MP2722_Result::OK;
+
+    Guard guard(*this);
+
+    uint8_t first = 0;
+    while (!(fields & (1 << first)))
+        first++;
+    uint8_t last = MP2722_STATUS_REG_COUNT - 1;
+    while (!(fields & (1 << last)))
+        last--;
+    uint8_t count = last - first + 1;
+
+    MP2722_Result ret = readRegs(MP2722_REG_STATUS11 + first, &status.regs[first], count);
+    if (ret != MP2722_Result::OK)
+        return ret;
+
+    onStatusRead(status, first, count);
+    recoverConfig();
+    return MP2722_Result::OK;
 }
 
 MP2722_Result MP2722::getStatus(PowerStatus &status)
 {
-    uint8_t buf[6];
-    uint8_t start_reg = MP2722_REG_STATUS11;
+    RawStatus raw;
+    MP2722_Result ret = getStatus(raw);
+    if (ret != MP2722_Result::OK)
+        return ret;
+
+    status = raw.toPowerStatus();
+    return MP2722_Result::OK;
+}
+
+MP2722_Result MP2722::getStatus(PowerStatus &status, uint32_t &events)
+{
+    Guard guard(*this);
+    RawStatus raw;
+    MP2722_Result ret = readStatus(raw); // Events come from bus reads only
+    if (ret == MP2722_Result::OK)
+        status = raw.toPowerStatus();
+    events = takeEvents();
+    return ret;
+}
+
+uint32_t MP2722::takeEvents()
+{
+    Guard guard(*this, false);
+    uint32_t events = _events;
+    _events = 0;
+    return events;
+}
+
+void MP2722::setEventCallback(MP2722_EventCallback callback, void *user)
+{
+    _eventCallback = callback;
+    _eventUser = user;
+}
+
+void MP2722_ISR_ATTR MP2722::onInterrupt(uint32_t timestamp)
+{
+    if (!_irqQueue.push(timestamp))
+        _irqDropped = _irqDropped + 1;
+}
 
-    MP2722_Result ret = readRegs(start_reg, buf, 6);
+MP2722_Result MP2722::service()
+{
+    Guard guard(*this);
+    AsyncCompletion completion;
+    while (_asyncDone.pop(completion)) // A backend completing in place queues the next one meanwhile
+        asyncStep(completion.result, completion.ended);
+    if (isBusy()) // The status read would be refused: keep the pulses for the call that ends the operation
+        return MP2722_Result::OK;
+
+    uint32_t timestamp;
+    uint8_t pulses = 0;
+    while (_irqQueue.pop(timestamp))
+        pulses++;
+    if (pulses == 0)
+        return MP2722_Result::OK;
+
+    MP2722_LOGD("%u interrupt(s)", pulses);
+    return pollStatus();
+}
+
+// One full status read, with the raised events passed to the event callback
+MP2722_Result MP2722::pollStatus()
+{
+    PowerStatus status{};
+    uint32_t events;
+    MP2722_Result ret = getStatus(status, events);
     if (ret != MP2722_Result::OK)
         return ret;
 
-    uint8_t reg11 = buf[0]; // DPDM / DPM
-    uint8_t reg12 = buf[1]; // Power / Therm / Watchdog
-    uint8_t reg13 = buf[2]; // Charger / Boost
-    uint8_t reg14 = buf[3]; // Physical Faults & NTC JEITA status
-    uint8_t reg15 = buf[4]; // CC1/CC2 vRa/vRd detection status (USB Type-C)
-    uint8_t reg16 = buf[5]; // Reserved for future status
+    if (events && _eventCallback)
+        _eventCallback(events, status, _eventUser);
+    return MP2722_Result::OK;
+}
+
+uint32_t MP2722::nextPollDelayMs() const
+{
+    Guard guard(*this, false);
+    if (!_lastStatusValid)
+        return 0; // Never read, poll now
+
+    RawStatus status;
+    memcpy(status.regs, _lastStatus, MP2722_STATUS_REG_COUNT);
+    ChargerStatus chg = status.chargerStatus();
+
+    bool fault = status.chargerFault() != ChargerFault::NONE || status.boostFault() != BoostFault::NONE ||
+                 status.faultWatchdog() || status.faultBattery() || status.faultNtc();
+    bool detecting = status.vinGood() && !status.vinReady(); // D+/D- detection in progress
+    bool regulating = status.thermalRegulation() || status.inputDpmRegulation() ||
+                      status.ntc1State() != NTCState::NORMAL || status.ntc2State() != NTCState::NORMAL;
+
+    uint32_t delay;
+    if (fault || detecting || chg == ChargerStatus::TRICKLE_CHARGE || chg == ChargerStatus::PRE_CHARGE)
+        delay = MP2722_POLL_FAST_MS;
+    else if (regulating)
+        delay = MP2722_POLL_REGULATION_MS;
+    else if (chg == ChargerStatus::FAST_CHARGE || chg == ChargerStatus::CONST_VOLTAGE)
+        delay = MP2722_POLL_CHARGING_MS;
+    else if (!status.vinGood())
+        delay = MP2722_POLL_BATTERY_MS; // On battery, nothing to follow but BATT_LOW
+    else
+        delay = MP2722_POLL_IDLE_MS; // Charge done, or input present without charging
+
+    // Things have been changing lately: keep a close eye for a while
+    if (_activity >= MP2722_POLL_BURST_ACTIVITY)
+        delay = MP2722_POLL_FAST_MS;
+    else if (_activity && delay > MP2722_POLL_CHARGING_MS)
+        delay = MP2722_POLL_CHARGING_MS;
+
+    return delay;
+}
+
+MP2722_Result MP2722::tick(uint32_t now_ms)
+{
+    Guard guard(*this);
+    _nowMs = now_ms;
+    MP2722_Result ret = service();
+    if (ret != MP2722_Result::OK || isBusy()) // The bus is taken: poll and kick on a later tick
+        return ret;
+
+    bool poll = !_polled || now_ms - _lastPollMs >= nextPollDelayMs();
+    if (poll)
+    {
+        _polled = true;
+        _lastPollMs = now_ms;
+        ret = pollStatus();
+        if (ret != MP2722_Result::OK)
+            return ret;
+    }
 
-    log(MP2722_LogLevel::INFO, "STATUS: R11=0x%02X R12=0x%02X R13=0x%02X R14=0x%02X R15=0x%02X R16=0x%02X",
-        reg11, reg12, reg13, reg14, reg15, reg16);
+    if (!_initialized || !watchdogEnabled())
+        return MP2722_Result::OK;
+
+    // Kick at half the period, or early if the next poll would come past it and we are on the bus anyway
+    uint32_t interval = watchdogPeriodMs() / 2;
+    uint32_t elapsed = now_ms - _lastKickMs;
+    if (!_kicked || elapsed >= interval || (poll && elapsed + nextPollDelayMs() > interval))
+        return watchdogKick();
+    return MP2722_Result::OK;
+}
+
+uint32_t MP2722::trackEvents(const uint8_t *buf)
+{
+    if (!_lastStatusValid)
+    {
+        memcpy(_lastStatus, buf, MP2722_STATUS_REG_COUNT);
+        _lastStatusValid = true;
+        return 0;
+    }
+
+    // Fast path: nothing changed, nothing to decode
+    uint8_t changed = 0;
+    for (size_t i = 0; i < MP2722_STATUS_REG_COUNT; i++)
+        changed |= _lastStatus[i] ^ buf[i];
+    if (!changed)
+        return 0;
+
+    uint32_t events = statusEvents(_lastStatus, buf);
+    _events |= events;
+    memcpy(_lastStatus, buf, MP2722_STATUS_REG_COUNT);
+    return events;
+}
+
+// Same trigger conditions as the INT_LIST interrupt sources (docs/INT_LIST.csv)
+uint32_t MP2722::statusEvents(const uint8_t *prev, const uint8_t *cur)
+{
+    uint8_t diff[MP2722_STATUS_REG_COUNT];
+    uint8_t rise[MP2722_STATUS_REG_COUNT];
+    for (size_t i = 0; i < MP2722_STATUS_REG_COUNT; i++)
+    {
+        diff[i] = prev[i] ^ cur[i];
+        rise[i] = diff[i] & cur[i];
+    }
+
+    uint32_t events = 0;
 
     // --- Register 11 ---
-    status.legacy_src_type = static_cast<LegacyInputSrcType>((reg11 & MP2722_DPDM_STAT_MASK) >> MP2722_DPDM_STAT_SHIFT);
-    status.input_dpm_regulation = (reg11 & (MP2722_VINDPM_STAT_MASK | MP2722_IINDPM_STAT_MASK)) != 0;
+    if (diff[0] & DPDM_STAT::mask)
+    {
+        events |= MP2722_EVT_DPDM_DET_DONE;
+        if (DPDM_STAT::get(cur[0]) == (uint8_t)LegacyInputSrcType::HIGH_VOLTAGE)
+            events |= MP2722_EVT_HVCHARGER;
+    }
+    if (rise[0] & VINDPM_STAT::mask)
+        events |= MP2722_EVT_VINDPM_STAT;
+    if (rise[0] & IINDPM_STAT::mask)
+        events |= MP2722_EVT_IINDPM_STAT;
 
     // --- Register 12 ---
-    status.vin_good = (reg12 & MP2722_VIN_GD_MASK) != 0;
-    status.vin_ready = (reg12 & MP2722_VIN_RDY_MASK) != 0;
-    status.charger_ready = status.vin_good && status.vin_ready;
-    status.vsys_regulation = (reg12 & MP2722_VSYS_STAT_MASK) != 0;
-    status.thermal_regulation = (reg12 & MP2722_THERM_STAT_MASK) != 0;
-    status.legacy_cable = (reg12 & MP2722_LEGACYCABLE_MASK) != 0;
-    status.fault_watchdog = (reg12 & MP2722_WATCHDOG_FAULT_MASK) != 0;
+    if (diff[1] & VIN_GD::mask)
+        events |= MP2722_EVT_VIN_GD;
+    if (rise[1] & VIN_RDY::mask)
+        events |= MP2722_EVT_VIN_RDY;
+    if (rise[1] & THERM_STAT::mask)
+        events |= MP2722_EVT_THERM_STAT;
+    if (rise[1] & WATCHDOG_FAULT::mask)
+        events |= MP2722_EVT_WATCHDOG_FAULT;
+    if (rise[1] & WATCHDOG_BARK::mask)
+        events |= MP2722_EVT_WATCHDOG_BARK;
 
     // --- Register 13 ---
-    status.charger_status = static_cast<ChargerStatus>((reg13 & MP2722_CHG_STAT_MASK) >> MP2722_CHG_STAT_SHIFT);
-    status.charger_fault = static_cast<ChargerFault>(reg13 & MP2722_CHG_FAULT_MASK);
-    status.boost_fault = static_cast<BoostFault>((reg13 & MP2722_BOOST_FAULT_MASK) >> MP2722_BOOST_FAULT_SHIFT);
+    if (diff[2] & CHG_STAT::mask)
+    {
+        ChargerStatus from = static_cast<ChargerStatus>(CHG_STAT::get(prev[2]));
+        ChargerStatus to = static_cast<ChargerStatus>(CHG_STAT::get(cur[2]));
+        if (to == ChargerStatus::CHARGE_DONE)
+            events |= MP2722_EVT_CHG_DONE;
+        else if (from == ChargerStatus::CHARGE_DONE &&
+                 (to == ChargerStatus::FAST_CHARGE || to == ChargerStatus::CONST_VOLTAGE))
+            events |= MP2722_EVT_RECHARGE;
+    }
+    if ((diff[2] & CHG_FAULT::mask) && CHG_FAULT::get(prev[2]) == 0)
+        events |= MP2722_EVT_CHG_FAULT;
+    if (diff[2] & BOOST_FAULT::mask)
+    {
+        BoostFault from = static_cast<BoostFault>(BOOST_FAULT::get(prev[2]));
+        BoostFault to = static_cast<BoostFault>(BOOST_FAULT::get(cur[2]));
+        if (from == BoostFault::NONE || (from == BoostFault::OVERVOLT && to == BoostFault::NONE))
+            events |= MP2722_EVT_BOOST_FAULT;
+    }
 
     // --- Register 14 ---
-    status.fault_battery = (reg14 & MP2722_BATT_MISSING_MASK) != 0;
-    status.fault_ntc = (reg14 & MP2722_NTC_MISSING_MASK) != 0;
-    status.ntc1_state = static_cast<NTCState>((reg14 & MP2722_NTC1_FAULT_MASK) >> MP2722_NTC1_FAULT_SHIFT);
-    status.ntc2_state = static_cast<NTCState>((reg14 & MP2722_NTC2_FAULT_MASK) >> MP2722_NTC2_FAULT_SHIFT);
+    if (diff[3] & NTC_MISSING::mask)
+        events |= MP2722_EVT_NTC_MISSING;
+    if (diff[3] & BATT_MISSING::mask)
+        events |= MP2722_EVT_BATT_MISSING;
+    if (diff[3] & (NTC1_FAULT::mask | NTC2_FAULT::mask))
+        events |= MP2722_EVT_NTC_FAULT;
 
     // --- Register 15 ---
-    status.cc1_snk_stat = static_cast<CCSinkStatus>((reg15 & MP2722_CC1_SNK_STAT_MASK) >> MP2722_CC1_SNK_STAT_SHIFT);
-    status.cc2_snk_stat = static_cast<CCSinkStatus>((reg15 & MP2722_CC2_SNK_STAT_MASK) >> MP2722_CC2_SNK_STAT_SHIFT);
-    status.cc1_src_stat = static_cast<CCSourceStatus>((reg15 & MP2722_CC1_SRC_STAT_MASK) >> MP2722_CC1_SRC_STAT_SHIFT);
-    status.cc2_src_stat = static_cast<CCSourceStatus>((reg15 & MP2722_CC2_SRC_STAT_MASK) >> MP2722_CC2_SRC_STAT_SHIFT);
+    if (diff[4] & (CC1_SNK_STAT::mask | CC2_SNK_STAT::mask))
+        events |= MP2722_EVT_CC_SNK;
+    if (diff[4] & (CC1_SRC_STAT::mask | CC2_SRC_STAT::mask))
+        events |= MP2722_EVT_CC_SRC;
 
     // --- Register 16 ---
-    status.topoff_active = (reg16 & MP2722_TOPOFF_ACTIVE_MASK) != 0;
-    status.bfet_stat = (reg16 & MP2722_BFET_STAT_MASK) != 0;
-    status.batt_low_stat = (reg16 & MP2722_BATT_LOW_STAT_MASK) != 0;
-    status.otg_need = (reg16 & MP2722_OTG_NEED_MASK) != 0;
-    status.vin_test_high = (reg16 & MP2722_VIN_TEST_HIGH_MASK) != 0;
-    status.debug_acc = (reg16 & MP2722_DEBUGACC_MASK) != 0;
-    status.audio_acc = (reg16 & MP2722_AUDIOACC_MASK) != 0;
+    if (diff[5] & TOPOFF_ACTIVE::mask)
+        events |= MP2722_EVT_TOPOFF_TMR;
+    if (rise[5] & BATT_LOW_STAT::mask)
+        events |= MP2722_EVT_BATT_LOW;
+    if (diff[5] & OTG_NEED::mask)
+        events |= MP2722_EVT_OTG_NEED;
+    if (rise[5] & VIN_TEST_HIGH::mask)
+        events |= MP2722_EVT_VIN_TEST_HIGH;
+    if (diff[5] & DEBUGACC::mask)
+        events |= MP2722_EVT_DEBUGACC;
+    if (diff[5] & AUDIOACC::mask)
+        events |= MP2722_EVT_AUDIOACC;
+
+    return events;
+}
+
+// Watchdog expiry resets part of the configuration behind our back. Called for every status read covering STATUS12h,
+// handled on the rising edge of the fault only (the cache may be reloaded or restored while the fault is still latched).
+// The edge is tracked apart from _lastStatus, which a partial read without a full baseline leaves unset.
+void MP2722::onWatchdogFault(bool fault)
+{
+    bool rising = fault && !_watchdogFault;
+    _watchdogFault = fault;
+    if (!rising)
+        return;
+
+    _shadowValidAtFault = _shadowValid;
+    _shadowValid = false;
+    if (_initialized && _appliedValid)
+        _recoveryPending = true;
+}
+
+// Write the applied configuration back in one burst over the registers holding watchdog-reset fields. EN_CHG (CONFIG09h)
+// comes after ICC and VBATT in the burst, so charging resumes with the restored setpoints.
+void MP2722::recoverConfig()
+{
+    if (!_recoveryPending || isBusy())
+        return;
+
+    uint8_t first = 0;
+    while (!watchdogResetBits[first])
+        first++;
+    uint8_t last = MP2722_CONFIG_REG_COUNT - 1;
+    while (!watchdogResetBits[last])
+        last--;
+
+    // Same LOCK_CHG ordering as applyConfig(): the lock survives the watchdog and would refuse the setpoints going
+    // back up, so the burst clears it and it is set again last
+    uint8_t buf[MP2722_CONFIG_REG_COUNT];
+    memcpy(buf, _applied, sizeof(buf));
+    uint8_t config0 = _applied[MP2722_REG_CONFIG0];
+    bool lock = LOCK_CHG::decode(config0);
+    buf[MP2722_REG_CONFIG0] &= ~LOCK_CHG::mask;
+
+    MP2722_LOGW("Watchdog reset the configuration, restoring it");
+    bool wasValid = _shadowValidAtFault;
+    MP2722_Result ret = writeRegs(first, &buf[first], last - first + 1);
+    if (ret == MP2722_Result::OK && lock)
+        ret = writeReg(MP2722_REG_CONFIG0, config0);
+    if (ret != MP2722_Result::OK)
+    {
+        _applied[MP2722_REG_CONFIG0] = config0; // Not the unlocked value of the burst
+        _shadowValidAtFault = wasValid;         // The retry rewrites the same registers
+        // Retried on the next status read. Until then the setpoints are the PMIC defaults and setCharging(true) is refused.
+        MP2722_LOGE("Failed to restore the configuration");
+        return;
+    }
+
+    // Registers outside the burst hold no watchdog-reset field, so a cache that was whole before the fault is again
+    if (_shadowValidAtFault)
+        _shadowValid = true;
+    _recoveryPending = false;
+    _events |= MP2722_EVT_CONFIG_RESTORED;
+}
+
+void MP2722::onStatusRead(const RawStatus &status, uint8_t first, uint8_t count)
+{
+    RawStatus full = status;
+    if (count < MP2722_STATUS_REG_COUNT)
+    {
+        MP2722_LOGD("STATUS: R%02X..R%02X partial read", MP2722_REG_STATUS11 + first,
+            MP2722_REG_STATUS11 + first + count - 1);
+
+        const uint8_t reg12 = MP2722_REG_STATUS12 - MP2722_REG_STATUS11;
+        if (first <= reg12 && reg12 < first + count)
+            onWatchdogFault(status.faultWatchdog());
+
+        // Change events and history need a full baseline, then the window is merged into it
+        if (!_lastStatusValid)
+            return;
+        memcpy(full.regs, _lastStatus, MP2722_STATUS_REG_COUNT);
+        memcpy(&full.regs[first], &status.regs[first], count);
+    }
+    else
+    {
+        MP2722_LOGD("STATUS: R11=0x%02X R12=0x%02X R13=0x%02X R14=0x%02X R15=0x%02X R16=0x%02X",
+            status.regs[0], status.regs[1], status.regs[2], status.regs[3], status.regs[4], status.regs[5]);
+
+        onWatchdogFault(status.faultWatchdog());
+    }
+
+    uint32_t timestamp = now();
+    if (_recorder)
+        _recorder->record(timestamp, full);
+    // Snapshot readers expect every register as of the timestamp, which a merged window is not
+    if (count == MP2722_STATUS_REG_COUNT)
+    {
+        MP2722_RecorderEntry snapshot = {timestamp, full};
+        _published.store(snapshot);
+    }
+
+    // Event density for the poll scheduler: +2 per read with events, -1 per quiet read
+    if (trackEvents(full.regs))
+        _activity = (_activity + 2 > MP2722_POLL_MAX_ACTIVITY) ? MP2722_POLL_MAX_ACTIVITY : _activity + 2;
+    else if (_activity)
+        _activity--;
+}
+
+// ============================================================================
+// Asynchronous API - a small state machine advanced by each transfer completion
+// ============================================================================
+
+// Completion context (possibly an ISR): only queue the result, service() runs the step
+void MP2722_ISR_ATTR MP2722::asyncTransferDone(void *arg, int result)
+{
+    MP2722 *dev = static_cast<MP2722 *>(arg);
+    AsyncCompletion completion = {result, dev->busTime()};
+    dev->_asyncDone.push(completion); // One transfer in flight at a time, never full
+}
+
+MP2722_Result MP2722::startAsync(AsyncOp op, MP2722_AsyncCallback callback, void *user)
+{
+    if (!_i2c.write || !_i2c.read || isBusy())
+        return MP2722_Result::INVALID_STATE;
+
+    _async.op = op;
+    _async.callback = callback;
+    _async.user = user;
+    return MP2722_Result::OK;
+}
+
+void MP2722::asyncTransfer(bool write, uint8_t start_reg, uint8_t len)
+{
+    _async.writing = write;
+    _async.xfer_reg = start_reg;
+    _async.xfer_len = len;
+
+    // Data lives in _async.buf at the register offset for burst writes of the INIT image, at 0 otherwise
+    uint8_t *data = (_async.op == AsyncOp::INIT && write) ? &_async.buf[start_reg] : _async.buf;
+
+    _async.started = busTime();
+    if (write && _i2c.write_async)
+    {
+        if (_i2c.write_async(_i2c.ctx, _address, start_reg, data, len, asyncTransferDone, this) != 0)
+            asyncFinish(MP2722_Result::FAIL);
+        return;
+    }
+    if (!write && _i2c.read_async)
+    {
+        if (_i2c.read_async(_i2c.ctx, _address, start_reg, data, len, asyncTransferDone, this) != 0)
+            asyncFinish(MP2722_Result::FAIL);
+        return;
+    }
+
+    // No async transfers on this platform, complete in place
+    int ret = write ? _i2c.write(_i2c.ctx, _address, start_reg, data, len)
+                    : _i2c.read(_i2c.ctx, _address, start_reg, data, len);
+    asyncStep(ret, busTime());
+}
+
+void MP2722::asyncStep(int result, uint32_t ended)
+{
+    bool ok = (result == 0);
+    recordTransfer(_async.writing, result, _async.xfer_len, ended - _async.started);
+    const uint8_t *data = (_async.op == AsyncOp::INIT && _async.writing) ? &_async.buf[_async.xfer_reg] : _async.buf;
+    if (_async.writing)
+        onRegsWritten(_async.xfer_reg, data, _async.xfer_len, ok);
+    else if (ok)
+        onRegsRead(_async.xfer_reg, data, _async.xfer_len);
+
+    if (!ok)
+    {
+        asyncFinish(MP2722_Result::FAIL);
+        return;
+    }
+
+    switch (_async.op)
+    {
+    case AsyncOp::UPDATE:
+    case AsyncOp::CHARGE_CURRENT:
+    case AsyncOp::CHARGE_VOLTAGE:
+    {
+        if (_async.writing)
+        {
+            asyncFinish(MP2722_Result::OK);
+            return;
+        }
+        uint8_t old_val = _async.buf[0];
+        uint8_t new_val = (old_val & ~_async.mask) | (_async.val & _async.mask);
+        if (new_val == old_val)
+        {
+            if (_stats)
+                _stats->writesAvoided++;
+            asyncFinish(MP2722_Result::OK);
+            return;
+        }
+        _async.buf[0] = new_val;
+        asyncTransfer(true, _async.reg, 1);
+        return;
+    }
+
+    case AsyncOp::STATUS:
+    {
+        RawStatus raw;
+        memcpy(raw.regs, _async.buf, MP2722_STATUS_REG_COUNT);
+        onStatusRead(raw);
+        *_async.status = raw.toPowerStatus();
+        asyncFinish(MP2722_Result::OK);
+        return;
+    }
+
+    case AsyncOp::INIT:
+    {
+        const uint32_t all_regs = (1UL << MP2722_CONFIG_REG_COUNT) - 1;
+        if (!_async.writing)
+        {
+            // The whole configuration block was just read, build the default image over it
+            Transaction tx(*this);
+            tx._fresh = all_regs;
+            stageInitDefaults(tx);
+            _async.dirty = tx.buildImage(_async.buf);
+            _async.next = 0;
+        }
+
+        uint8_t start, len;
+        if (findRun(_async.dirty, all_regs, _async.next, start, len))
+        {
+            _async.next = start + len;
+            asyncTransfer(true, start, len);
+            return;
+        }
+
+        _initialized = true;
+        MP2722_LOGI("MP2722 Initialized. CONFIG0=0x%02X", _shadow[MP2722_REG_CONFIG0]);
+        asyncFinish(MP2722_Result::OK);
+        return;
+    }
+
+    default:
+        asyncFinish(MP2722_Result::INVALID_STATE);
+        return;
+    }
+}
+
+void MP2722::asyncFinish(MP2722_Result result)
+{
+    bool ok = (result == MP2722_Result::OK);
+    AsyncOp op = _async.op;
+    switch (op)
+    {
+    case AsyncOp::CHARGE_CURRENT:
+        _isChargeCurrentSet = ok;
+        break;
+    case AsyncOp::CHARGE_VOLTAGE:
+        _isChargeVoltageSet = ok;
+        break;
+    case AsyncOp::INIT:
+        if (!ok)
+            MP2722_LOGE("Failed to initialize MP2722");
+        break;
+    default:
+        break;
+    }
+
+    // Release the state machine before notifying, so the callback can chain the next operation
+    MP2722_AsyncCallback callback = _async.callback;
+    void *user = _async.user;
+    _async.op = AsyncOp::NONE;
+    _async.writing = false;
+
+    // A status read that found a watchdog fault restores the configuration (blocking) before the caller acts on it
+    if (op == AsyncOp::STATUS && ok)
+        recoverConfig();
+
+    if (callback)
+        callback(result, user);
+}
+
+MP2722_Result MP2722::startUpdateAsync(AsyncOp op, uint8_t reg, uint8_t mask, uint8_t val,
+                                       MP2722_AsyncCallback callback, void *user)
+{
+    MP2722_Result ret = startAsync(op, callback, user);
+    if (ret != MP2722_Result::OK)
+        return ret;
+
+    _async.reg = reg;
+    _async.mask = mask;
+    _async.val = val;
+
+    if (!isCached(reg))
+    {
+        asyncTransfer(false, reg, 1);
+        return MP2722_Result::OK;
+    }
 
+    uint8_t new_val = (_shadow[reg] & ~mask) | (val & mask);
+    if (new_val == _shadow[reg])
+    {
+        if (_stats)
+            _stats->writesAvoided++;
+        asyncFinish(MP2722_Result::OK);
+        return MP2722_Result::OK;
+    }
+    _async.buf[0] = new_val;
+    asyncTransfer(true, reg, 1);
     return MP2722_Result::OK;
 }
+
+MP2722_Result MP2722::initAsync(MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    MP2722_Result ret = startAsync(AsyncOp::INIT, callback, user);
+    if (ret != MP2722_Result::OK)
+    {
+        MP2722_LOGE("No I2C interface provided or an operation is already in progress");
+        return ret;
+    }
+
+    asyncTransfer(false, MP2722_REG_CONFIG0, MP2722_CONFIG_REG_COUNT);
+    return MP2722_Result::OK;
+}
+
+MP2722_Result MP2722::getStatusAsync(PowerStatus &status, MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    MP2722_Result ret = startAsync(AsyncOp::STATUS, callback, user);
+    if (ret != MP2722_Result::OK)
+        return ret;
+
+    _async.status = &status;
+    asyncTransfer(false, MP2722_REG_STATUS11, MP2722_STATUS_REG_COUNT);
+    return MP2722_Result::OK;
+}
+
+MP2722_Result MP2722::setChargeCurrentAsync(uint16_t current_ma, MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    return startUpdateAsync(AsyncOp::CHARGE_CURRENT, ICC::reg, ICC::mask, ICC::encode(current_ma), callback, user);
+}
+
+MP2722_Result MP2722::setChargeVoltageAsync(uint16_t voltage_mv, MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    return startUpdateAsync(AsyncOp::CHARGE_VOLTAGE, VBATT_REG::reg, VBATT_REG::mask, VBATT_REG::encode(voltage_mv),
+                            callback, user);
+}
+
+MP2722_Result MP2722::setInputCurrentLimitAsync(uint16_t current_ma, MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    return startUpdateAsync(AsyncOp::UPDATE, IIN_LIM::reg, IIN_LIM::mask, IIN_LIM::encode(current_ma), callback, user);
+}
+
+MP2722_Result MP2722::setChargingAsync(bool enable, MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    if (enable && !chargeSetpointsValid())
+    {
+        MP2722_LOGE("Charge FAULT: Voltage and Current must be adjusted first!");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    return startUpdateAsync(AsyncOp::UPDATE, EN_CHG::reg, EN_CHG::mask, EN_CHG::encode(enable), callback, user);
+}
+
+MP2722_Result MP2722::watchdogKickAsync(MP2722_AsyncCallback callback, void *user)
+{
+    Guard guard(*this, false);
+    if (!_initialized)
+    {
+        MP2722_LOGE("init() must be called first");
+        return MP2722_Result::INVALID_STATE;
+    }
+
+    return startUpdateAsync(AsyncOp::UPDATE, WATCHDOG_RST::reg, WATCHDOG_RST::mask, WATCHDOG_RST::encode(true),
+                            callback, user);
+}
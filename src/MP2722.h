@@ -7,8 +7,45 @@
 
 #include "MP2722_defs.h"
 #include "MP2722_regs.h"
+#include "MP2722_fields.h"
+#include "MP2722_queue.h"
+#include "MP2722_status.h"
+#include "MP2722_recorder.h"
+#include "MP2722_stats.h"
+#include "MP2722_config.h"
+#include "MP2722_dump.h"
 #include "MP2722_platform.h"
 
+#ifndef MP2722_POLL_FAST_MS
+#define MP2722_POLL_FAST_MS 250 // Faults, D+/D- detection, trickle/pre-charge, bursts of events
+#endif
+#ifndef MP2722_POLL_REGULATION_MS
+#define MP2722_POLL_REGULATION_MS 500 // Thermal/DPM regulation, JEITA zone other than normal
+#endif
+#ifndef MP2722_POLL_CHARGING_MS
+#define MP2722_POLL_CHARGING_MS 1000 // Fast charge / constant voltage, or a recent event
+#endif
+#ifndef MP2722_POLL_IDLE_MS
+#define MP2722_POLL_IDLE_MS 5000 // Input present, charge done or not charging
+#endif
+#ifndef MP2722_POLL_BATTERY_MS
+#define MP2722_POLL_BATTERY_MS 10000 // No valid input
+#endif
+#define MP2722_POLL_BURST_ACTIVITY 4 // Event activity score switching to the fast interval
+#define MP2722_POLL_MAX_ACTIVITY 8
+
+#ifndef MP2722_IRQ_QUEUE_SIZE
+#define MP2722_IRQ_QUEUE_SIZE 8 // Pending INT pulses between two service() calls (power of two)
+#endif
+
+#ifndef MP2722_LOG_MAX_LEVEL
+#define MP2722_LOG_MAX_LEVEL MP2722_LOG_LEVEL_DEBUG // Log calls above this level are compiled out, format strings included
+#endif
+#ifndef MP2722_LOG_DEFER_SIZE
+#define MP2722_LOG_DEFER_SIZE 0 // Log records queued until flushLog() (power of two), 0 formats them in place
+#endif
+#define MP2722_LOG_MAX_ARGS 6 // Arguments per log call, all int-sized
+
 /**
  * @brief Driver for MPS MP2722 Battery Charger
  */
@@ -33,6 +70,176 @@ public:
      */
     void setLogCallback(MP2722_LogLevel level = MP2722_LogLevel::INFO, MP2722_LogCallback callback = nullptr);
 
+    /**
+     * @brief Format and emit the queued log records (deferred logging, `MP2722_LOG_DEFER_SIZE` > 0).
+     *
+     * In deferred mode the driver only copies the format string pointer and raw arguments of each log call into a
+     * lock-free queue, so formatting and the log callback never run in the bus path. Call this from a low-priority
+     * context (idle task, main loop); it may run concurrently with the context that uses the driver.
+     *
+     * @param max Maximum number of records to emit
+     * @return Number of records emitted (always 0 without deferred logging)
+     */
+    uint8_t flushLog(uint8_t max = 255);
+
+    /**
+     * @brief Deferred log records lost because the queue was full
+     */
+    uint32_t droppedLogs() const { return _logDropped; }
+
+    /**
+     * @brief Make every public call atomic against other threads sharing this driver (default: no locking).
+     *
+     * @param lock Recursive lock, e.g. from `MP2722_FreeRtosLock` or `MP2722_StdLock` (`{}` to remove)
+     * @note - Set it before the driver is shared. `onInterrupt()` and `flushLog()` never take it.
+     */
+    void setLock(const MP2722_Lock &lock) { _lock = lock; }
+
+    /**
+     * @brief Hold the bus against other drivers on it for the whole of each public call, so a read-modify-write or a
+     *        Transaction is one unit on the bus. Taken after the `setLock()` lock.
+     *
+     * @param lock Recursive lock shared by every driver of the bus (`{}` to remove)
+     * @note - Not held across asynchronous transfers: the asynchronous API only takes the `setLock()` lock to start.
+     */
+    void setBusLock(const MP2722_Lock &lock) { _busLock = lock; }
+
+    /**
+     * @brief Set the time source used to timestamp status snapshots (e.g. `millis`). Without one, the last `tick()` time is used.
+     */
+    void setClock(MP2722_ClockCallback clock) { _clock = clock; }
+
+    /**
+     * @brief Attach a flight recorder that keeps the status history around faults. Pass nullptr to detach.
+     *
+     * @code
+     * static MP2722_FlightRecorderBuffer<32> recorder; // 32 state changes, 16 of them after a fault
+     * pmic.attachRecorder(&recorder);
+     * @endcode
+     */
+    void attachRecorder(MP2722_FlightRecorder *recorder) { _recorder = recorder; }
+
+    /**
+     * @brief Attach a bus statistics block: transfer counts, bytes, failures, writes avoided and latency histograms.
+     *
+     * @param stats Storage updated by every transfer (nullptr to detach). Not reset by this call.
+     * @param timer Optional time source for the latency histograms, in any tick unit (e.g. `micros`). Also called
+     *        where asynchronous transfers complete, possibly an ISR, so it must be ISR-safe (and in IRAM on ESP-IDF).
+     */
+    void attachBusStats(MP2722_BusStats *stats, MP2722_ClockCallback timer = nullptr)
+    {
+        _stats = stats;
+        _statsTimer = timer;
+    }
+
+    /** @brief Attached bus statistics, or nullptr */
+    const MP2722_BusStats *getBusStats() const { return _stats; }
+
+    /**
+     * @brief Retry failed idempotent transfers (reads, and writes without action bits) of the synchronous API.
+     *
+     * @code
+     * pmic.setRetryPolicy({3, 2, 8, 20, delay}); // Up to 3 attempts, 2 ms then 4 ms apart, within 20 ms
+     * @endcode
+     *
+     * The time budget is measured with the `setClock()` clock when set, otherwise as the sum of the waits.
+     * @note - Asynchronous transfers are not retried.
+     */
+    void setRetryPolicy(const MP2722_RetryPolicy &policy) { _retry = policy; }
+
+    /** @brief Clear the attached bus statistics */
+    void resetBusStats()
+    {
+        if (_stats)
+            _stats->reset();
+    }
+
+    /**
+     * @brief Enable or Disable the configuration register cache (shadow copy of CONFIG00h~10h).
+     *
+     * When enabled, setters compute the new register value from the cached copy instead of reading it back first,
+     * so a field change costs a single write, or no bus access at all when the value is already set.
+     * The cache is filled by one burst read (see `syncRegisterCache()`), kept coherent on every write and
+     * invalidated on `reset()`, failed writes and watchdog faults.
+     *
+     * @note - Disabled by default. Only enable it if nothing else on the bus writes to the PMIC configuration.
+     * @note - CONFIG1 (IIN_LIM) is updated by the PMIC itself after input source detection, so it is always read.
+     */
+    void setRegisterCache(bool enable);
+
+    /**
+     * @brief Reload the configuration register cache from the PMIC in a single burst read.
+     */
+    MP2722_Result syncRegisterCache();
+
+    /**
+     * @brief Batch of configuration field updates applied with the fewest possible bus transactions.
+     *
+     * Updates are staged in RAM by `update()`, then `commit()` reads the base values of the touched registers
+     * in a single burst (or takes them from the register cache), and writes every changed register with
+     * auto-increment burst writes, merging neighbouring changes into one transaction.
+     *
+     * @code
+     * MP2722::Transaction tx = pmic.beginTransaction();
+     * tx.update(MP2722_REG_CONFIG9, MP2722_EN_BUCK_MASK, MP2722_EN_BUCK_MASK)
+     *   .update(MP2722_REG_CONFIGA, MP2722_AUTODPDM_MASK, MP2722_AUTODPDM_MASK);
+     * tx.commit();
+     * @endcode
+     */
+    class Transaction
+    {
+    public:
+        /**
+         * @brief Read the whole configuration block (CONFIG00h~10h) in one burst so that `commit()` needs no reads.
+         */
+        MP2722_Result load();
+
+        /**
+         * @brief Stage a field update. Several updates to the same register are merged.
+         *
+         * @param reg   Configuration register (CONFIG00h~10h)
+         * @param mask  Bits to change
+         * @param val   New value of the masked bits
+         */
+        Transaction &update(uint8_t reg, uint8_t mask, uint8_t val);
+
+        /**
+         * @brief Stage a field update from its descriptor (see `MP2722_Fields`). The value is clamped to the field range.
+         */
+        template <typename Field>
+        Transaction &set(uint16_t value)
+        {
+            return update(Field::reg, Field::mask, Field::encode(value));
+        }
+
+        /**
+         * @brief Apply every staged update. Registers that end up unchanged are not written.
+         *
+         * @note - Whatever the outcome, the staged updates and the values read for them are dropped, so the next
+         *         batch staged on the same transaction starts from fresh register values.
+         */
+        MP2722_Result commit();
+
+    private:
+        friend class MP2722;
+        explicit Transaction(MP2722 &dev) : _dev(dev) {}
+
+        uint32_t staged() const;
+        uint32_t buildImage(uint8_t *image);
+        MP2722_Result apply();
+
+        MP2722 &_dev;
+        uint8_t _mask[MP2722_CONFIG_REG_COUNT] = {};
+        uint8_t _value[MP2722_CONFIG_REG_COUNT] = {};
+        uint32_t _fresh = 0; // Registers read within this transaction (bit per register)
+        bool _invalid = false;
+    };
+
+    /**
+     * @brief Start a batch of configuration updates. See `Transaction`.
+     */
+    Transaction beginTransaction();
+
     /**
      * @brief Initialize the driver and check device presence
      */
@@ -43,6 +250,28 @@ public:
      */
     MP2722_Result reset();
 
+    /**
+     * @brief Write a whole configuration profile (CONFIG00h~10h) in one burst. See `MP2722_Config`.
+     *
+     * @param config Profile to apply
+     * @param verify Read the block back in one burst and fail if any register differs (e.g. refused by LOCK_CHG)
+     * @note - A profile with LOCK_CHG set takes one more single-register write: the lock is set after the burst, or it
+     *         would refuse higher ICC, IPRE, VBATT and JEITA values written after CONFIG00h.
+     */
+    MP2722_Result applyConfig(const MP2722_Config &config, bool verify = false);
+
+    /**
+     * @brief Read the whole register file (REG00h~16h) in one burst. Also counts as a status read (events, recorder,
+     *        watchdog recovery).
+     */
+    MP2722_Result dumpRegisters(MP2722_RegisterDump &dump);
+
+    /**
+     * @brief Write back the writable configuration bits of a dump. Only the registers that differ are written, read
+     *        and written in bursts like a `Transaction` (LOCK_CHG, if set in the dump, is written last).
+     */
+    MP2722_Result restoreConfig(const MP2722_RegisterDump &dump);
+
     /**
      * @brief Imediately perform D+/D- detection for USB input source type detection.
      *
@@ -76,14 +305,20 @@ public:
      *
      * @param current_ma Charge current in mA (Range: 80-5000mA, Step: 80mA approx)
      */
-    MP2722_Result setChargeCurrent(uint16_t current_ma);
+    MP2722_Result setChargeCurrent(uint16_t current_ma)
+    {
+        return writeChargeCurrent(MP2722_Fields::ICC::encode(current_ma)); // Folds to a constant for constant values
+    }
 
     /**
      * @brief Set Charge Voltage (VBATT_REG)
      *
      * @param voltage_mv Charge voltage in mV (Range: 3600-4600mV)
      */
-    MP2722_Result setChargeVoltage(uint16_t voltage_mv);
+    MP2722_Result setChargeVoltage(uint16_t voltage_mv)
+    {
+        return writeChargeVoltage(MP2722_Fields::VBATT_REG::encode(voltage_mv));
+    }
 
     /**
      * @brief Set Input Current Limit (IIN_LIM)
@@ -93,7 +328,10 @@ public:
      *
      * @param current_ma Input current limit in mA (Range: 100-3200mA)
      */
-    MP2722_Result setInputCurrentLimit(uint16_t current_ma);
+    MP2722_Result setInputCurrentLimit(uint16_t current_ma)
+    {
+        return writeInputCurrentLimit(MP2722_Fields::IIN_LIM::encode(current_ma));
+    }
 
     /**
      * @brief Enable or Disable Charging
@@ -153,13 +391,179 @@ public:
      */
     MP2722_Result getStatus(PowerStatus &status);
 
+    /**
+     * @brief Read all PMIC status registers without decoding them.
+     *
+     * @param status Reference to RawStatus to fill; fields are extracted on access (e.g. `status.chargerStatus()`)
+     */
+    MP2722_Result getStatus(RawStatus &status);
+
+    /**
+     * @brief Read only the status registers holding the requested fields.
+     *
+     * Reads the smallest contiguous window covering `fields` in one burst (e.g. `MP2722_STATUS_CHARGER` alone is a
+     * 1-byte read of REG13h). Bytes outside the window are left untouched in `status`.
+     *
+     * @param fields `MP2722_StatusFields` bits
+     * @param status Reference to RawStatus to update
+     */
+    MP2722_Result getStatus(uint8_t fields, RawStatus &status);
+
+    /**
+     * @brief Read all PMIC status registers and report what changed.
+     *
+     * @param status Reference to PowerStatus struct to fill with current PMIC status
+     * @param events Set to the `MP2722_Event` bits raised since the last call (same as `takeEvents()`)
+     *
+     * @note - Events are derived from consecutive status reads (any `getStatus*()` counts), so transitions
+     *         shorter than the polling interval are missed. The very first read raises none.
+     */
+    MP2722_Result getStatus(PowerStatus &status, uint32_t &events);
+
+    /**
+     * @brief Serve `getStatus()` (except the `events` variant) from the latest published snapshot while it is at most
+     *        `max_age_ms` old, instead of reading the bus. Needs `setClock()`. 0 disables it (default).
+     *
+     * @note - Meant for several threads reading the status while one of them polls (e.g. with `tick()`): snapshot hits
+     *         take no lock at all.
+     */
+    void setStatusMaxAge(uint32_t max_age_ms) { _statusMaxAge = max_age_ms; }
+
+    /**
+     * @brief Copy the latest status published by any full status read, without bus access or locking.
+     *
+     * Every full status read publishes its result through a sequence lock, so any number of threads can call this while
+     * another one polls.
+     *
+     * @param status Latest snapshot
+     * @param age_ms If not null, set to the snapshot age in milliseconds (see `setClock()`)
+     * @return false if no status was read yet, or the snapshot was being replaced (`getStatus()` then reads the bus)
+     */
+    bool peekStatus(RawStatus &status, uint32_t *age_ms = nullptr) const;
+
+    /**
+     * @brief Return and clear the `MP2722_Event` bits raised by status reads since the last call.
+     */
+    uint32_t takeEvents();
+
+    /**
+     * @name Event-driven status
+     *
+     * Wire the INT pin (open-drain, active-low pulse) to a falling-edge interrupt that calls `onInterrupt()`, and call
+     * `service()` from task context. Each burst of interrupts costs one status read, and the raised events go to the
+     * event callback. Periodic `getStatus()` is then only needed as a fallback for missed pulses.
+     *
+     * `tick()` combines both: it services interrupts and polls status at the interval recommended for the current
+     * charger state (`nextPollDelayMs()`).
+     * @{
+     */
+
+    /**
+     * @brief Set the callback receiving the events found by `service()`
+     */
+    void setEventCallback(MP2722_EventCallback callback, void *user = nullptr);
+
+    /**
+     * @brief Record an INT pulse. Safe to call from an ISR (lock-free, no bus access).
+     *
+     * @param timestamp Optional capture time of the pulse, in any unit
+     */
+    void onInterrupt(uint32_t timestamp = 0);
+
+    /**
+     * @brief Handle the interrupts recorded since the last call: one burst status read and event dispatch.
+     *        Does nothing (no bus traffic) if there were none.
+     *
+     * Also advances the running asynchronous operation past the transfers completed since the last call. Interrupts
+     * recorded while that operation is still running are kept for the first call after it ends.
+     */
+    MP2722_Result service();
+
+    /**
+     * @brief Recommended delay before the next status poll, from the last status read.
+     *
+     * Short while something is in progress (faults, D+/D- detection, trickle/pre-charge, recent bursts of events),
+     * longer during regulation and CC/CV charge, and long once charge is done or running from battery.
+     * See the MP2722_POLL_*_MS settings. Returns 0 before the first status read.
+     */
+    uint32_t nextPollDelayMs() const;
+
+    /**
+     * @brief Run the status scheduler: services pending interrupts, then polls status when `nextPollDelayMs()` has
+     *        elapsed, dispatching raised events to the event callback. Call often (e.g. every loop iteration).
+     *        While an asynchronous operation runs, the poll and the watchdog kick wait for a later call.
+     *
+     * @param now_ms Current time in milliseconds (wrap-around safe)
+     */
+    MP2722_Result tick(uint32_t now_ms);
+
+    /**
+     * @brief Number of INT pulses dropped because the queue was full (the next `service()` still reads status)
+     */
+    uint32_t droppedInterrupts() const { return _irqDropped; }
+    /** @} */
+
     /**
      * @brief Kick PMIC Watchdog to prevent it from resetting registers to default.
      *
-     * @note - MP2722 watchdog period defaults to 40s. Kicking it every few seconds is fine.
+     * @note - A single write of the known CONFIG7h value (a read-modify-write only if it is unknown).
+     * @note - `tick()` kicks automatically at half the watchdog period, or earlier on a tick that polls status when
+     *         the next poll would come too late. The kick stays its own write, right after the poll. Any configuration
+     *         write covering CONFIG7h kicks it too.
      */
     MP2722_Result watchdogKick();
 
+    /**
+     * @brief Set the watchdog period. Expiry resets the configuration registers to their defaults.
+     *
+     * @note - Default: 40s.
+     */
+    MP2722_Result setWatchdog(WatchdogTimer period);
+
+    /**
+     * @brief Watchdog period in milliseconds as currently configured (0 if disabled, POR default unless CONFIG7h is
+     *        cached, see `setRegisterCache()`)
+     */
+    uint32_t watchdogPeriodMs() const;
+
+    /**
+     * @brief Set the charge safety timer.
+     *
+     * @param timer Timer duration (default: 10 hours)
+     * @param double_in_regulation Run the timer at half speed during DPM/thermal regulation (EN_TMR2X, default: true)
+     */
+    MP2722_Result setChargeTimer(ChargeTimer timer, bool double_in_regulation = true);
+
+    /**
+     * @name Asynchronous API
+     *
+     * Non-blocking variants of the main API. Each call starts the operation and returns immediately. Every I2C
+     * transfer completion (`MP2722_I2C::write_async`/`read_async`) is only queued, possibly from an ISR; `service()`
+     * (or `tick()`) then advances the operation in task context and finally calls `callback(result, user)`.
+     *
+     * @note - Only one asynchronous operation can run at a time, see `isBusy()`. Blocking calls fail with
+     * INVALID_STATE while it runs.
+     * @note - Register bookkeeping, logging and the callback never run in the completion context.
+     * @note - A status read finding a watchdog fault restores the configuration with blocking writes, from `service()`,
+     * before its callback.
+     * @note - Without async transfer functions, the blocking ones are used and the callback runs before returning.
+     * @return OK if the operation was started (the callback will be called), an error otherwise (it won't).
+     * @{
+     */
+    MP2722_Result initAsync(MP2722_AsyncCallback callback, void *user = nullptr);
+    MP2722_Result getStatusAsync(PowerStatus &status, MP2722_AsyncCallback callback, void *user = nullptr);
+    MP2722_Result setChargeCurrentAsync(uint16_t current_ma, MP2722_AsyncCallback callback, void *user = nullptr);
+    MP2722_Result setChargeVoltageAsync(uint16_t voltage_mv, MP2722_AsyncCallback callback, void *user = nullptr);
+    MP2722_Result setInputCurrentLimitAsync(uint16_t current_ma, MP2722_AsyncCallback callback, void *user = nullptr);
+    MP2722_Result setChargingAsync(bool enable, MP2722_AsyncCallback callback, void *user = nullptr);
+    MP2722_Result watchdogKickAsync(MP2722_AsyncCallback callback, void *user = nullptr);
+
+    /**
+     * @brief True while an asynchronous operation is in progress
+     */
+    bool isBusy() const { return _async.op != AsyncOp::NONE; }
+    /** @} */
+
     /**
      * @brief Enter shipping mode by setting BATTFET_DIS (Bit 5 in CONFIG8), effectively disconnecting the battery.
      *
@@ -172,17 +576,167 @@ private:
     MP2722_I2C _i2c = {};
     uint8_t _address = MP2722_I2C_ADDRESS;
 
+    MP2722_Lock _lock = {};    // Public call atomicity
+    MP2722_Lock _busLock = {}; // Shared bus arbitration
+
     MP2722_LogCallback _logCallback = {};
     MP2722_LogLevel _logLevel = MP2722_LogLevel::INFO;
 
+    // One log call: format string (in flash, used as the record id) and its raw arguments
+    struct LogRecord
+    {
+        const char *fmt;
+        int args[MP2722_LOG_MAX_ARGS];
+        MP2722_LogLevel level;
+    };
+#if MP2722_LOG_DEFER_SIZE > 0
+    MP2722_SpscQueue<LogRecord, MP2722_LOG_DEFER_SIZE> _logQueue; // log() -> flushLog()
+#endif
+    uint32_t _logDropped = 0;
+
     bool _initialized = false;
     bool _isChargeCurrentSet = false;
     bool _isChargeVoltageSet = false;
 
+    uint8_t _shadow[MP2722_CONFIG_REG_COUNT] = {}; // Last known CONFIG00h~10h values (self-clearing bits always 0)
+    bool _shadowValid = false;
+    bool _cacheEnabled = false;
+    uint8_t _applied[MP2722_CONFIG_REG_COUNT] = {}; // Configuration as last written, restored after a watchdog fault
+    bool _appliedValid = false;
+    bool _recoveryPending = false;
+    bool _shadowValidAtFault = false; // Shadow trusted when the watchdog fault was raised, valid again once restored
+    bool _watchdogFault = false;      // WATCHDOG_FAULT in the last status read covering STATUS12h
+
+    uint8_t _lastStatus[MP2722_STATUS_REG_COUNT] = {}; // Previous STATUS11h~16h read, for change events
+    bool _lastStatusValid = false;
+    uint32_t _events = 0; // MP2722_Event bits not taken yet
+
+    MP2722_SpscQueue<uint32_t, MP2722_IRQ_QUEUE_SIZE> _irqQueue; // onInterrupt() -> service()
+    volatile uint32_t _irqDropped = 0;                           // Written by onInterrupt() only
+    MP2722_EventCallback _eventCallback = nullptr;
+    uint8_t _activity = 0; // Recent event density, see nextPollDelayMs()
+    bool _polled = false;  // _lastPollMs valid
+    uint32_t _lastPollMs = 0;
+    uint32_t _nowMs = 0; // Latest tick() time, when no clock is set
+    bool _kicked = false; // _lastKickMs valid
+    uint32_t _lastKickMs = 0;
+
+    MP2722_Seqlock<MP2722_RecorderEntry> _published; // Latest status, for peekStatus()
+    uint32_t _statusMaxAge = 0;                       // Snapshot age served by getStatus(), 0: always read
+
+    MP2722_ClockCallback _clock = nullptr;
+    MP2722_FlightRecorder *_recorder = nullptr;
+    MP2722_BusStats *_stats = nullptr;
+    MP2722_ClockCallback _statsTimer = nullptr;
+    MP2722_RetryPolicy _retry = {};
+    void *_eventUser = nullptr;
+
+    enum class AsyncOp : uint8_t
+    {
+        NONE,
+        UPDATE,
+        CHARGE_CURRENT,
+        CHARGE_VOLTAGE,
+        STATUS,
+        INIT,
+    };
+
+    struct AsyncState
+    {
+        AsyncOp op = AsyncOp::NONE;
+        bool writing = false;  // Transfer in flight is a write
+        uint8_t xfer_reg = 0;  // Start register of the transfer in flight
+        uint8_t xfer_len = 0;  // Length of the transfer in flight
+        uint8_t reg = 0;       // UPDATE: register
+        uint8_t mask = 0;      // UPDATE: bits to change
+        uint8_t val = 0;       // UPDATE: new value of the masked bits
+        uint8_t next = 0;      // INIT: first register not written yet
+        uint32_t dirty = 0;    // INIT: registers to write
+        uint32_t started = 0;  // Start time of the transfer in flight (bus statistics)
+        uint8_t buf[MP2722_CONFIG_REG_COUNT] = {};
+        PowerStatus *status = nullptr;
+        MP2722_AsyncCallback callback = nullptr;
+        void *user = nullptr;
+    } _async;
+
+    // Transfer completion handed from its (possibly interrupt) context to service()
+    struct AsyncCompletion
+    {
+        int result;
+        uint32_t ended; // Bus statistics timer at completion
+    };
+    MP2722_SpscQueue<AsyncCompletion, 2> _asyncDone; // asyncTransferDone() -> service()
+
+    // Holds the driver lock, then the bus lock, for the scope of a public call (unset locks are skipped)
+    class Guard
+    {
+    public:
+        explicit Guard(const MP2722 &dev, bool bus = true) : _dev(dev), _bus(bus && dev._busLock.lock)
+        {
+            if (_dev._lock.lock)
+                _dev._lock.lock(_dev._lock.ctx);
+            if (_bus)
+                _dev._busLock.lock(_dev._busLock.ctx);
+        }
+
+        ~Guard()
+        {
+            if (_bus)
+                _dev._busLock.unlock(_dev._busLock.ctx);
+            if (_dev._lock.unlock)
+                _dev._lock.unlock(_dev._lock.ctx);
+        }
+
+    private:
+        const MP2722 &_dev;
+        bool _bus;
+    };
+
+    MP2722_Result writeRegs(uint8_t start_reg, const uint8_t *buf, size_t len);
     MP2722_Result writeReg(uint8_t reg, uint8_t val);
     MP2722_Result readRegs(uint8_t start_reg, uint8_t *buf, size_t len);
     MP2722_Result readReg(uint8_t reg, uint8_t &val);
     MP2722_Result updateReg(uint8_t reg, uint8_t mask, uint8_t val);
 
-    void log(MP2722_LogLevel level, const char *fmt, ...);
+    template <typename Field>
+    MP2722_Result updateField(uint16_t value)
+    {
+        return updateReg(Field::reg, Field::mask, Field::encode(value));
+    }
+
+    MP2722_Result writeChargeCurrent(uint8_t icc);
+    MP2722_Result writeChargeVoltage(uint8_t vbatt);
+    MP2722_Result writeInputCurrentLimit(uint8_t iin_lim);
+
+    void updateShadow(uint8_t start_reg, const uint8_t *buf, size_t len);
+    void onRegsRead(uint8_t start_reg, const uint8_t *buf, size_t len);
+    void onRegsWritten(uint8_t start_reg, const uint8_t *buf, size_t len, bool ok);
+    void stageInitDefaults(Transaction &tx);
+    void onStatusRead(const RawStatus &status, uint8_t first = 0, uint8_t count = MP2722_STATUS_REG_COUNT);
+    uint32_t trackEvents(const uint8_t *buf);
+    MP2722_ISR_INLINE uint32_t busTime() const { return _statsTimer ? _statsTimer() : 0; }
+    void recordTransfer(bool write, int result, size_t len, uint32_t ticks);
+    int transfer(bool write, uint8_t start_reg, uint8_t *buf, size_t len, bool retry);
+    MP2722_Result readStatus(RawStatus &status);
+    void onWatchdogFault(bool fault);
+    void recoverConfig();
+    bool freshStatus(RawStatus &status) const;
+    MP2722_Result pollStatus();
+    uint32_t now() const { return _clock ? _clock() : _nowMs; }
+    bool watchdogEnabled() const { return watchdogPeriodMs() != 0; }
+    bool chargeSetpointsValid() const { return _isChargeCurrentSet && _isChargeVoltageSet && !_recoveryPending; }
+    static uint32_t statusEvents(const uint8_t *prev, const uint8_t *cur);
+
+    MP2722_Result startAsync(AsyncOp op, MP2722_AsyncCallback callback, void *user);
+    MP2722_Result startUpdateAsync(AsyncOp op, uint8_t reg, uint8_t mask, uint8_t val,
+                                   MP2722_AsyncCallback callback, void *user);
+    void asyncTransfer(bool write, uint8_t start_reg, uint8_t len);
+    void asyncStep(int result, uint32_t ended);
+    void asyncFinish(MP2722_Result result);
+    static void asyncTransferDone(void *arg, int result);
+    bool isCached(uint8_t reg) const;
+    uint32_t cachedRegs() const;
+
+    void log(MP2722_LogLevel level, uint8_t argc, const char *fmt, ...);
+    void emitLog(const LogRecord &record) const;
 };
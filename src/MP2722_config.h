@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "MP2722_regs.h"
+#include "MP2722_fields.h"
+#include "MP2722_regmap.h"
+
+// Not constexpr on purpose: `MP2722_Config::set()` only calls it for a value outside the field range, so such a value
+// fails to compile when the profile is a constant expression. At runtime the value is clamped instead.
+inline uint16_t MP2722_CONFIG_VALUE_OUT_OF_RANGE(uint16_t value)
+{
+    return value;
+}
+
+/**
+ * @brief Complete configuration profile: the image of CONFIG00h~10h, built field by field at compile time.
+ *
+ * Every field of `MP2722_Fields` in the configuration block can be set (physical units for ranged fields, raw code for
+ * enumerated ones), except the action bits REG_RST, WATCHDOG_RST, FORCEDPDM, HVUP and HVDOWN. Each `set()` returns a
+ * new profile, so a whole profile folds into a 17-byte constant. Applied with `MP2722::applyConfig()`.
+ *
+ * @code
+ * using namespace MP2722_Fields;
+ * static constexpr MP2722_Config profile = MP2722_Config::porDefaults()
+ *     .set<ICC>(1000)        // mA
+ *     .set<VBATT_REG>(4200)  // mV
+ *     .set<IPRE>(160).set<ITERM>(60)
+ *     .set<TREG>(100)        // °C
+ *     .set<MASK_DPM>(true);
+ * static_assert(profile.get<ICC>() == 960, "ICC is rounded down to its 80mA step");
+ * @endcode
+ */
+class MP2722_Config
+{
+public:
+    /** @brief Power-on values of CONFIG00h~10h (Ref. docs/REG_MAP_CONFIG.csv) */
+    static constexpr MP2722_Config porDefaults()
+    {
+        return MP2722_Config(MP2722_POR_VALUES);
+    }
+
+    /**
+     * @brief Profile with one field changed
+     *
+     * @tparam Field Configuration field descriptor from `MP2722_Fields`
+     * @param value  Physical value, raw code or flag state
+     */
+    template <typename Field>
+    constexpr MP2722_Config set(uint16_t value) const
+    {
+        static_assert(Field::reg < MP2722_CONFIG_REG_COUNT, "Not a configuration register field");
+        static_assert((Field::mask & actionBits(Field::reg)) == 0, "Action bits are not part of a configuration profile");
+        return MP2722_Config(*this, Field::reg, Field::mask,
+                             Field::encode(Field::inRange(value) ? value : MP2722_CONFIG_VALUE_OUT_OF_RANGE(value)));
+    }
+
+    /** @brief Value of a field in the profile */
+    template <typename Field>
+    constexpr auto get() const -> decltype(Field::decode(0))
+    {
+        return Field::decode(_regs[Field::reg]);
+    }
+
+    /** @brief Value of a configuration register in the profile */
+    constexpr uint8_t reg(uint8_t addr) const { return _regs[addr]; }
+
+    /** @brief The 17 register values, CONFIG00h first */
+    const uint8_t *image() const { return _regs; }
+
+    /** @brief Bits the PMIC acts on and clears by itself, never stored in a profile */
+    static constexpr uint8_t actionBits(uint8_t reg)
+    {
+        return reg == MP2722_REG_CONFIG0   ? MP2722_REG_RST_MASK
+               : reg == MP2722_REG_CONFIG7 ? MP2722_WATCHDOG_RST_MASK
+               : reg == MP2722_REG_CONFIGA ? MP2722_FORCEDPDM_MASK
+               : reg == MP2722_REG_CONFIGB ? MP2722_HVUP_MASK | MP2722_HVDOWN_MASK
+                                           : 0;
+    }
+
+private:
+    uint8_t _regs[MP2722_CONFIG_REG_COUNT];
+
+    constexpr MP2722_Config(uint8_t r0, uint8_t r1, uint8_t r2, uint8_t r3, uint8_t r4, uint8_t r5, uint8_t r6,
+                            uint8_t r7, uint8_t r8, uint8_t r9, uint8_t ra, uint8_t rb, uint8_t rc, uint8_t rd,
+                            uint8_t re, uint8_t rf, uint8_t r10)
+        : _regs{r0, r1, r2, r3, r4, r5, r6, r7, r8, r9, ra, rb, rc, rd, re, rf, r10} {}
+
+#define MP2722_CONFIG_MERGE(i) (i == reg ? (uint8_t)((base._regs[i] & ~mask) | bits) : base._regs[i])
+    constexpr MP2722_Config(const MP2722_Config &base, uint8_t reg, uint8_t mask, uint8_t bits)
+        : _regs{MP2722_CONFIG_MERGE(0), MP2722_CONFIG_MERGE(1), MP2722_CONFIG_MERGE(2), MP2722_CONFIG_MERGE(3),
+                MP2722_CONFIG_MERGE(4), MP2722_CONFIG_MERGE(5), MP2722_CONFIG_MERGE(6), MP2722_CONFIG_MERGE(7),
+                MP2722_CONFIG_MERGE(8), MP2722_CONFIG_MERGE(9), MP2722_CONFIG_MERGE(10), MP2722_CONFIG_MERGE(11),
+                MP2722_CONFIG_MERGE(12), MP2722_CONFIG_MERGE(13), MP2722_CONFIG_MERGE(14), MP2722_CONFIG_MERGE(15),
+                MP2722_CONFIG_MERGE(16)} {}
+#undef MP2722_CONFIG_MERGE
+};
@@ -28,6 +28,13 @@ enum class MP2722_LogLevel : uint8_t
     DEBUG,
 };
 
+// Numeric log levels, for preprocessor use (MP2722_LOG_MAX_LEVEL)
+#define MP2722_LOG_LEVEL_NONE 0
+#define MP2722_LOG_LEVEL_ERROR 1
+#define MP2722_LOG_LEVEL_WARN 2
+#define MP2722_LOG_LEVEL_INFO 3
+#define MP2722_LOG_LEVEL_DEBUG 4
+
 /**
  * @brief User-provided logging callback signature
  *
@@ -36,32 +43,112 @@ enum class MP2722_LogLevel : uint8_t
  */
 typedef void (*MP2722_LogCallback)(MP2722_LogLevel level, const char *message);
 
+/**
+ * @brief Completion notification of an asynchronous I2C transfer (see `MP2722_I2C::write_async`)
+ *
+ * @param arg    Opaque argument given when the transfer was started
+ * @param result 0 on success, non-zero on failure
+ */
+typedef void (*MP2722_I2CDone)(void *arg, int result);
+
+/**
+ * @brief Completion callback of the driver *Async() API
+ *
+ * @param result Outcome of the whole operation
+ * @param user   User argument given when the operation was started
+ */
+typedef void (*MP2722_AsyncCallback)(MP2722_Result result, void *user);
+
+/**
+ * @brief Monotonic time source (e.g. milliseconds since boot), see MP2722::setClock()
+ */
+typedef uint32_t (*MP2722_ClockCallback)(void);
+
 /**
  * @brief User-provided I2C read/write interface
  *
  * Users implement these two functions for their platform (Arduino Wire, ESP-IDF, STM32 HAL, etc.)
+ * The asynchronous variants are optional: without them the driver *Async() API runs the blocking functions instead.
+ *
+ * Every function receives `ctx` as its first argument, so one implementation can serve several buses or devices
+ * (e.g. `ctx` points to the bus handle) without globals.
  */
 struct MP2722_I2C
 {
     /**
      * @brief Write bytes to a register
+     * @param ctx      User context (`MP2722_I2C::ctx`)
      * @param address  7-bit I2C device address
      * @param reg      Register address
      * @param data     Pointer to data to write
      * @param len      Number of bytes to write
      * @return 0 on success, non-zero on failure
      */
-    int (*write)(uint8_t address, uint8_t reg, const uint8_t *data, size_t len);
+    int (*write)(void *ctx, uint8_t address, uint8_t reg, const uint8_t *data, size_t len);
 
     /**
      * @brief Read bytes from a register
+     * @param ctx      User context (`MP2722_I2C::ctx`)
      * @param address  7-bit I2C device address
      * @param reg      Start register address
      * @param data     Buffer to read into
      * @param len      Number of bytes to read
      * @return 0 on success, non-zero on failure
      */
-    int (*read)(uint8_t address, uint8_t reg, uint8_t *data, size_t len);
+    int (*read)(void *ctx, uint8_t address, uint8_t reg, uint8_t *data, size_t len);
+
+    /**
+     * @brief User context passed as first argument to every function above and below
+     */
+    void *ctx;
+
+    /**
+     * @brief (Optional) Start writing bytes to a register without blocking
+     *
+     * `done(done_arg, result)` must be called exactly once when the transfer ends, possibly from interrupt context
+     * or before this function returns. `data` stays valid until then.
+     *
+     * @return 0 if the transfer was started, non-zero otherwise (`done` is then never called)
+     */
+    int (*write_async)(void *ctx, uint8_t address, uint8_t reg, const uint8_t *data, size_t len,
+                       MP2722_I2CDone done, void *done_arg);
+
+    /**
+     * @brief (Optional) Start reading bytes from a register without blocking
+     *
+     * Same completion rules as `write_async`. `data` must not be accessed by the caller until `done` is called.
+     *
+     * @return 0 if the transfer was started, non-zero otherwise (`done` is then never called)
+     */
+    int (*read_async)(void *ctx, uint8_t address, uint8_t reg, uint8_t *data, size_t len,
+                      MP2722_I2CDone done, void *done_arg);
+};
+
+/**
+ * @brief Lock hooks (see `MP2722::setLock()` and `MP2722::setBusLock()`).
+ *
+ * The lock must be recursive: a public call may be made while the same thread already holds it.
+ */
+struct MP2722_Lock
+{
+    void (*lock)(void *ctx);
+    void (*unlock)(void *ctx);
+    void *ctx; // Passed to both functions (e.g. the mutex)
+};
+
+/**
+ * @brief Retry policy of the register access layer (see `MP2722::setRetryPolicy()`).
+ *
+ * Only idempotent transfers are retried: reads, and writes that set none of the REG_RST, FORCEDPDM, HVUP and HVDOWN
+ * action bits (a NAK does not tell whether the PMIC already acted on them).
+ */
+struct MP2722_RetryPolicy
+{
+    uint8_t max_attempts;          // Attempts per transfer, 0 or 1 disables retries
+    uint16_t backoff_ms;           // Wait before the first retry, doubled before each next one
+    uint16_t max_backoff_ms;       // Cap of the doubled wait
+    uint32_t budget_ms;            // Max time from the first attempt to the start of the last one (0: no limit)
+    void (*delay_ms)(uint32_t ms); // Wait function (nullptr: retry at once)
 };
 
 // ============================================================================
@@ -134,6 +221,22 @@ enum class CCSourceStatus : uint8_t
     vRa = 0b10,   // CC detects vRa
 };
 
+enum class WatchdogTimer : uint8_t
+{
+    DISABLED = 0b00, // Watchdog off, configuration is never reset by it
+    SEC_40 = 0b01,   // Default
+    SEC_80 = 0b10,
+    SEC_160 = 0b11,
+};
+
+enum class ChargeTimer : uint8_t
+{
+    DISABLED = 0b00, // No charge safety timer
+    HOURS_5 = 0b01,
+    HOURS_10 = 0b10, // Default
+    HOURS_15 = 0b11,
+};
+
 // ============================================================================
 // Power status struct
 // ============================================================================
@@ -175,3 +278,50 @@ struct PowerStatus
     bool debug_acc;     // Debug Accessory Detected
     bool audio_acc;     // Audio Accessory Detected
 };
+
+// ============================================================================
+// Status change events
+// ============================================================================
+
+/**
+ * @brief Status change events (bitmask), one per interrupt source with the same trigger (Ref. docs/INT_LIST.csv)
+ * Derived by comparing consecutive reads of STATUS11h~16h, plus the driver's own recovery events.
+ */
+enum MP2722_Event : uint32_t
+{
+    MP2722_EVT_VIN_GD = 1UL << 0,          // VIN_GD changes
+    MP2722_EVT_DPDM_DET_DONE = 1UL << 1,   // DPDM_STAT changes
+    MP2722_EVT_VIN_RDY = 1UL << 2,         // VIN_RDY 0->1
+    MP2722_EVT_CHG_DONE = 1UL << 3,        // CHG_STAT any -> done
+    MP2722_EVT_RECHARGE = 1UL << 4,        // CHG_STAT done -> CC/CV charge
+    MP2722_EVT_THERM_STAT = 1UL << 5,      // THERM_STAT 0->1
+    MP2722_EVT_WATCHDOG_FAULT = 1UL << 6,  // WATCHDOG_FAULT 0->1
+    MP2722_EVT_WATCHDOG_BARK = 1UL << 7,   // WATCHDOG_BARK 0->1
+    MP2722_EVT_CHG_FAULT = 1UL << 8,       // CHG_FAULT none -> any fault
+    MP2722_EVT_NTC_MISSING = 1UL << 9,     // NTC_MISSING changes
+    MP2722_EVT_BATT_MISSING = 1UL << 10,   // BATT_MISSING changes
+    MP2722_EVT_BOOST_FAULT = 1UL << 11,    // BOOST_FAULT none -> any fault, or OVP -> none
+    MP2722_EVT_NTC_FAULT = 1UL << 12,      // NTC1_FAULT or NTC2_FAULT changes
+    MP2722_EVT_VINDPM_STAT = 1UL << 13,    // VINDPM_STAT 0->1
+    MP2722_EVT_IINDPM_STAT = 1UL << 14,    // IINDPM_STAT 0->1
+    MP2722_EVT_TOPOFF_TMR = 1UL << 15,     // TOPOFF_ACTIVE changes
+    MP2722_EVT_CC_SNK = 1UL << 16,         // CC1_SNK_STAT or CC2_SNK_STAT changes
+    MP2722_EVT_CC_SRC = 1UL << 17,         // CC1_SRC_STAT or CC2_SRC_STAT changes
+    MP2722_EVT_BATT_LOW = 1UL << 18,       // BATT_LOW_STAT 0->1
+    MP2722_EVT_OTG_NEED = 1UL << 19,       // OTG_NEED changes
+    MP2722_EVT_VIN_TEST_HIGH = 1UL << 20,  // VIN_TEST_HIGH 0->1
+    MP2722_EVT_DEBUGACC = 1UL << 21,       // DEBUGACC changes
+    MP2722_EVT_AUDIOACC = 1UL << 22,       // AUDIOACC changes
+    MP2722_EVT_HVCHARGER = 1UL << 23,      // DPDM_STAT any -> high-voltage adapter
+    MP2722_EVT_CONFIG_RESTORED = 1UL << 24, // Driver restored the configuration reset by a watchdog expiry
+    MP2722_EVT_ALL = (1UL << 25) - 1,
+};
+
+/**
+ * @brief Status change event callback, see MP2722::setEventCallback()
+ *
+ * @param events  `MP2722_Event` bits raised
+ * @param status  Status decoded from the read that raised them
+ * @param user    Pointer given to setEventCallback()
+ */
+typedef void (*MP2722_EventCallback)(uint32_t events, const PowerStatus &status, void *user);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "MP2722_regs.h"
+#include "MP2722_status.h"
+
+/**
+ * @brief Changed field callback, see `MP2722_RegisterDump::diff()`
+ *
+ * @param name    Field name as in docs/REG_MAP_*.csv (e.g. "ICC")
+ * @param reg     Register address
+ * @param from    Field code in the dump `diff()` was called on
+ * @param to      Field code in the other dump
+ * @param user    Pointer given to `diff()`
+ */
+typedef void (*MP2722_FieldDiffCallback)(const char *name, uint8_t reg, uint8_t from, uint8_t to, void *user);
+
+/**
+ * @brief Snapshot of the whole register file (REG00h~16h), taken in one burst by `MP2722::dumpRegisters()`.
+ *
+ * Restored with `MP2722::restoreConfig()`, compared field by field with `diff()`.
+ */
+struct MP2722_RegisterDump
+{
+    uint8_t regs[MP2722_REG_COUNT];
+
+    /** @brief Value of register `address` (00h~16h) */
+    uint8_t reg(uint8_t address) const { return regs[address]; }
+
+    /** @brief Status part (STATUS11h~16h) */
+    RawStatus status() const
+    {
+        RawStatus raw;
+        memcpy(raw.regs, &regs[MP2722_REG_STATUS11], MP2722_STATUS_REG_COUNT);
+        return raw;
+    }
+
+    /**
+     * @brief Compare with another dump, field by field in register order (reserved bits are ignored)
+     *
+     * @param other    Dump to compare with
+     * @param callback Called for each field that differs (nullptr to only count them)
+     * @param user     Passed to `callback`
+     * @return Number of fields that differ
+     */
+    uint8_t diff(const MP2722_RegisterDump &other, MP2722_FieldDiffCallback callback = nullptr,
+                 void *user = nullptr) const;
+};
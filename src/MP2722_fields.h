@@ -0,0 +1,248 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "MP2722_regs.h"
+
+/**
+ * @brief Register field descriptor with constexpr encode/decode and range checking.
+ *
+ * A field maps a physical value (mA, mV, °C, or a plain code) to the bits of one register:
+ * `value = Base + code * Step`, with `code` stored in `Mask` starting at bit `Shift`.
+ *
+ * Encoding clamps the value to [Min, Max] and rounds it down to the nearest step. The division by `Step` is done with
+ * a compile-time reciprocal (multiply + shift), so there's no runtime division even on cores without a divide
+ * instruction, and constant values fold to an immediate register value.
+ *
+ * @code
+ * static_assert(MP2722_Fields::ICC::encode(1000) == 12, "");
+ * @endcode
+ *
+ * @tparam Reg   Register address
+ * @tparam Mask  Field bits within the register
+ * @tparam Shift Position of the field LSB
+ * @tparam Base  Physical value of code 0
+ * @tparam Step  Physical value of one code LSB
+ * @tparam Min   Lowest accepted physical value (default: Base)
+ * @tparam Max   Highest accepted physical value (default: value of the largest code)
+ */
+template <uint8_t Reg, uint8_t Mask, uint8_t Shift, uint16_t Base = 0, uint16_t Step = 1,
+          uint16_t Min = Base, uint16_t Max = Base + Step * (Mask >> Shift)>
+struct MP2722_Field
+{
+    static constexpr uint8_t reg = Reg;
+    static constexpr uint8_t mask = Mask;
+    static constexpr uint8_t shift = Shift;
+    static constexpr uint16_t base = Base;
+    static constexpr uint16_t step = Step;
+    static constexpr uint16_t min = Min;
+    static constexpr uint16_t max = Max;
+    static constexpr uint8_t max_code = Mask >> Shift;
+
+    // ceil(2^24 / Step): floor(n * recip / 2^24) == floor(n / Step) for every n in the field range (asserted below)
+    static constexpr uint32_t recip = ((1UL << 24) + Step - 1) / Step;
+
+    static_assert(Step > 0, "Field step must be non-zero");
+    static_assert(Min >= Base && Max >= Min, "Field range must start at or above its base");
+    static_assert((Max - Base) / Step <= (Mask >> Shift), "Field range exceeds its register bits");
+    static_assert((uint64_t)(Max - Base) * recip <= 0xFFFFFFFFULL, "Field range overflows the reciprocal product");
+    static_assert((uint64_t)(Max - Base) * (recip * Step - (1UL << 24)) < (1ULL << 24),
+                  "Reciprocal division is not exact over the field range");
+
+    /** @brief True if `value` is within [Min, Max] */
+    static constexpr bool inRange(uint16_t value) { return value >= Min && value <= Max; }
+
+    /** @brief `value` clamped to [Min, Max] */
+    static constexpr uint16_t clamp(uint16_t value) { return value < Min ? Min : (value > Max ? Max : value); }
+
+    /** @brief Field code for a physical value (clamped, rounded down to the nearest step) */
+    static constexpr uint8_t code(uint16_t value)
+    {
+        return (uint8_t)(((uint32_t)(clamp(value) - Base) * recip) >> 24);
+    }
+
+    /** @brief Register bits for a physical value, ready to be used with `mask` */
+    static constexpr uint8_t encode(uint16_t value) { return (uint8_t)((code(value) << Shift) & Mask); }
+
+    /** @brief Field code held by a register value */
+    static constexpr uint8_t get(uint8_t reg_val) { return (uint8_t)((reg_val & Mask) >> Shift); }
+
+    /** @brief Physical value held by a register value */
+    static constexpr uint16_t decode(uint8_t reg_val) { return (uint16_t)(Base + get(reg_val) * Step); }
+};
+
+/**
+ * @brief Single-bit register field descriptor.
+ */
+template <uint8_t Reg, uint8_t Mask>
+struct MP2722_Flag
+{
+    static constexpr uint8_t reg = Reg;
+    static constexpr uint8_t mask = Mask;
+
+    /** @brief True if `value` is a flag state (0 or 1) */
+    static constexpr bool inRange(uint16_t value) { return value <= 1; }
+
+    /** @brief Register bits for the flag state, ready to be used with `mask` */
+    static constexpr uint8_t encode(bool enable) { return enable ? Mask : 0; }
+
+    /** @brief Flag state held by a register value */
+    static constexpr bool decode(uint8_t reg_val) { return (reg_val & Mask) != 0; }
+};
+
+/**
+ * @brief Descriptors of every MP2722 register field (Ref. docs/REG_MAP_CONFIG.csv and docs/REG_MAP_STATUS.csv).
+ *
+ * Physical ranges are given in mA, mV or °C. Enumerated fields (no unit) take the raw code.
+ */
+namespace MP2722_Fields
+{
+    /* CONFIG0 (0x00) */
+    typedef MP2722_Flag<MP2722_REG_CONFIG0, MP2722_REG_RST_MASK> REG_RST;
+    typedef MP2722_Flag<MP2722_REG_CONFIG0, MP2722_EN_STAT_IB_MASK> EN_STAT_IB;
+    typedef MP2722_Flag<MP2722_REG_CONFIG0, MP2722_EN_PG_NTC2_MASK> EN_PG_NTC2;
+    typedef MP2722_Flag<MP2722_REG_CONFIG0, MP2722_LOCK_CHG_MASK> LOCK_CHG;
+    typedef MP2722_Flag<MP2722_REG_CONFIG0, MP2722_HOLDOFF_TMR_MASK> HOLDOFF_TMR;
+    typedef MP2722_Field<MP2722_REG_CONFIG0, MP2722_SW_FREQ_MASK, MP2722_SW_FREQ_SHIFT> SW_FREQ;
+    typedef MP2722_Flag<MP2722_REG_CONFIG0, MP2722_EN_VIN_TRK_MASK> EN_VIN_TRK;
+
+    /* CONFIG1 (0x01) */
+    typedef MP2722_Field<MP2722_REG_CONFIG1, MP2722_IIN_MODE_MASK, MP2722_IIN_MODE_SHIFT> IIN_MODE;
+    typedef MP2722_Field<MP2722_REG_CONFIG1, MP2722_IIN_LIM_MASK, MP2722_IIN_LIM_SHIFT,
+                         MP2722_IIN_LIM_BASE, MP2722_IIN_LIM_STEP, 100, 3200> IIN_LIM; // mA
+
+    /* CONFIG2 (0x02) */
+    typedef MP2722_Field<MP2722_REG_CONFIG2, MP2722_VPRE_MASK, MP2722_VPRE_SHIFT> VPRE;
+    typedef MP2722_Field<MP2722_REG_CONFIG2, MP2722_ICC_MASK, MP2722_ICC_SHIFT,
+                         MP2722_ICC_BASE, MP2722_ICC_STEP, 80, 5000> ICC; // mA
+
+    /* CONFIG3 (0x03) */
+    typedef MP2722_Field<MP2722_REG_CONFIG3, MP2722_IPRE_MASK, MP2722_IPRE_SHIFT,
+                         MP2722_IPRE_BASE, MP2722_IPRE_STEP> IPRE; // mA (80-680)
+    typedef MP2722_Field<MP2722_REG_CONFIG3, MP2722_ITERM_MASK, MP2722_ITERM_SHIFT,
+                         MP2722_ITERM_BASE, MP2722_ITERM_STEP> ITERM; // mA (30-480)
+
+    /* CONFIG4 (0x04) */
+    typedef MP2722_Flag<MP2722_REG_CONFIG4, MP2722_VRECHG_MASK> VRECHG;
+    typedef MP2722_Field<MP2722_REG_CONFIG4, MP2722_ITRICKLE_MASK, MP2722_ITRICKLE_SHIFT,
+                         MP2722_ITRICKLE_BASE, MP2722_ITRICKLE_STEP> ITRICKLE; // mA (32-256)
+    typedef MP2722_Field<MP2722_REG_CONFIG4, MP2722_VIN_LIM_MASK, MP2722_VIN_LIM_SHIFT,
+                         MP2722_VIN_LIM_BASE, MP2722_VIN_LIM_STEP> VIN_LIM; // mV (3880-5080)
+
+    /* CONFIG5 (0x05) */
+    typedef MP2722_Field<MP2722_REG_CONFIG5, MP2722_TOPOFF_TMR_MASK, MP2722_TOPOFF_TMR_SHIFT> TOPOFF_TMR;
+    typedef MP2722_Field<MP2722_REG_CONFIG5, MP2722_VBATT_REG_MASK, MP2722_VBATT_REG_SHIFT,
+                         MP2722_VBATT_REG_BASE, MP2722_VBATT_REG_STEP, 3600, 4600> VBATT_REG; // mV
+
+    /* CONFIG6 (0x06) */
+    typedef MP2722_Field<MP2722_REG_CONFIG6, MP2722_VIN_OVP_MASK, MP2722_VIN_OVP_SHIFT> VIN_OVP;
+    typedef MP2722_Field<MP2722_REG_CONFIG6, MP2722_SYS_MIN_MASK, MP2722_SYS_MIN_SHIFT, 0, 1, 0, 6> SYS_MIN;
+    typedef MP2722_Field<MP2722_REG_CONFIG6, MP2722_TREG_MASK, MP2722_TREG_SHIFT, 60, 10, 60, 120> TREG; // °C
+
+    /* CONFIG7 (0x07) */
+    typedef MP2722_Flag<MP2722_REG_CONFIG7, MP2722_IB_EN_MASK> IB_EN;
+    typedef MP2722_Flag<MP2722_REG_CONFIG7, MP2722_WATCHDOG_RST_MASK> WATCHDOG_RST;
+    typedef MP2722_Field<MP2722_REG_CONFIG7, MP2722_WATCHDOG_MASK, MP2722_WATCHDOG_SHIFT> WATCHDOG;
+    typedef MP2722_Flag<MP2722_REG_CONFIG7, MP2722_EN_TERM_MASK> EN_TERM;
+    typedef MP2722_Flag<MP2722_REG_CONFIG7, MP2722_EN_TMR2X_MASK> EN_TMR2X;
+    typedef MP2722_Field<MP2722_REG_CONFIG7, MP2722_CHG_TIMER_MASK, MP2722_CHG_TIMER_SHIFT> CHG_TIMER;
+
+    /* CONFIG8 (0x08) */
+    typedef MP2722_Flag<MP2722_REG_CONFIG8, MP2722_BATTFET_DIS_MASK> BATTFET_DIS;
+    typedef MP2722_Flag<MP2722_REG_CONFIG8, MP2722_BATTFET_DLY_MASK> BATTFET_DLY;
+    typedef MP2722_Flag<MP2722_REG_CONFIG8, MP2722_BATTFET_RST_EN_MASK> BATTFET_RST_EN;
+    typedef MP2722_Field<MP2722_REG_CONFIG8, MP2722_OLIM_MASK, MP2722_OLIM_SHIFT> OLIM;
+    typedef MP2722_Field<MP2722_REG_CONFIG8, MP2722_VBOOST_MASK, MP2722_VBOOST_SHIFT> VBOOST;
+
+    /* CONFIG9 (0x09) */
+    typedef MP2722_Field<MP2722_REG_CONFIG9, MP2722_CC_CFG_MASK, MP2722_CC_CFG_SHIFT, 0, 1, 0, 5> CC_CFG;
+    typedef MP2722_Flag<MP2722_REG_CONFIG9, MP2722_AUTOOTG_MASK> AUTOOTG;
+    typedef MP2722_Flag<MP2722_REG_CONFIG9, MP2722_EN_BOOST_MASK> EN_BOOST;
+    typedef MP2722_Flag<MP2722_REG_CONFIG9, MP2722_EN_BUCK_MASK> EN_BUCK;
+    typedef MP2722_Flag<MP2722_REG_CONFIG9, MP2722_EN_CHG_MASK> EN_CHG;
+
+    /* CONFIGA (0x0A) */
+    typedef MP2722_Flag<MP2722_REG_CONFIGA, MP2722_AUTODPDM_MASK> AUTODPDM;
+    typedef MP2722_Flag<MP2722_REG_CONFIGA, MP2722_FORCEDPDM_MASK> FORCEDPDM;
+    typedef MP2722_Field<MP2722_REG_CONFIGA, MP2722_RP_CFG_MASK, MP2722_RP_CFG_SHIFT, 0, 1, 0, 2> RP_CFG;
+    typedef MP2722_Field<MP2722_REG_CONFIGA, MP2722_FORCE_CC_MASK, MP2722_FORCE_CC_SHIFT> FORCE_CC;
+
+    /* CONFIGB (0x0B) */
+    typedef MP2722_Flag<MP2722_REG_CONFIGB, MP2722_HVEN_MASK> HVEN;
+    typedef MP2722_Flag<MP2722_REG_CONFIGB, MP2722_HVUP_MASK> HVUP;
+    typedef MP2722_Flag<MP2722_REG_CONFIGB, MP2722_HVDOWN_MASK> HVDOWN;
+    typedef MP2722_Field<MP2722_REG_CONFIGB, MP2722_HVREQ_MASK, MP2722_HVREQ_SHIFT> HVREQ;
+
+    /* CONFIGC (0x0C) */
+    typedef MP2722_Flag<MP2722_REG_CONFIGC, MP2722_NTC1_ACTION_MASK> NTC1_ACTION;
+    typedef MP2722_Flag<MP2722_REG_CONFIGC, MP2722_NTC2_ACTION_MASK> NTC2_ACTION;
+    typedef MP2722_Flag<MP2722_REG_CONFIGC, MP2722_BATT_OVP_EN_MASK> BATT_OVP_EN;
+    typedef MP2722_Field<MP2722_REG_CONFIGC, MP2722_BATT_LOW_MASK, MP2722_BATT_LOW_SHIFT, 3000, 100> BATT_LOW; // mV
+    typedef MP2722_Flag<MP2722_REG_CONFIGC, MP2722_BOOST_STP_EN_MASK> BOOST_STP_EN;
+    typedef MP2722_Flag<MP2722_REG_CONFIGC, MP2722_BOOST_OTP_EN_MASK> BOOST_OTP_EN;
+
+    /* CONFIGD (0x0D) */
+    typedef MP2722_Field<MP2722_REG_CONFIGD, MP2722_WARM_ACT_MASK, MP2722_WARM_ACT_SHIFT> WARM_ACT;
+    typedef MP2722_Field<MP2722_REG_CONFIGD, MP2722_COOL_ACT_MASK, MP2722_COOL_ACT_SHIFT> COOL_ACT;
+    typedef MP2722_Field<MP2722_REG_CONFIGD, MP2722_JEITA_VSET_MASK, MP2722_JEITA_VSET_SHIFT> JEITA_VSET;
+    typedef MP2722_Field<MP2722_REG_CONFIGD, MP2722_JEITA_ISET_MASK, MP2722_JEITA_ISET_SHIFT, 0, 1, 0, 2> JEITA_ISET;
+
+    /* CONFIGE (0x0E) */
+    typedef MP2722_Field<MP2722_REG_CONFIGE, MP2722_VHOT_MASK, MP2722_VHOT_SHIFT> VHOT;
+    typedef MP2722_Field<MP2722_REG_CONFIGE, MP2722_VWARM_MASK, MP2722_VWARM_SHIFT> VWARM;
+    typedef MP2722_Field<MP2722_REG_CONFIGE, MP2722_VCOOL_MASK, MP2722_VCOOL_SHIFT> VCOOL;
+    typedef MP2722_Field<MP2722_REG_CONFIGE, MP2722_VCOLD_MASK, MP2722_VCOLD_SHIFT> VCOLD;
+
+    /* CONFIGF (0x0F) */
+    typedef MP2722_Flag<MP2722_REG_CONFIGF, MP2722_VIN_SRC_EN_MASK> VIN_SRC_EN;
+    typedef MP2722_Field<MP2722_REG_CONFIGF, MP2722_IVIN_SRC_MASK, MP2722_IVIN_SRC_SHIFT, 0, 1, 0, 8> IVIN_SRC;
+    typedef MP2722_Field<MP2722_REG_CONFIGF, MP2722_VIN_TEST_MASK, MP2722_VIN_TEST_SHIFT> VIN_TEST;
+
+    /* CONFIG10 (0x10) */
+    typedef MP2722_Flag<MP2722_REG_CONFIG10, MP2722_MASK_THERM_MASK> MASK_THERM;
+    typedef MP2722_Flag<MP2722_REG_CONFIG10, MP2722_MASK_DPM_MASK> MASK_DPM;
+    typedef MP2722_Flag<MP2722_REG_CONFIG10, MP2722_MASK_TOPOFF_MASK> MASK_TOPOFF;
+    typedef MP2722_Flag<MP2722_REG_CONFIG10, MP2722_MASK_CC_INT_MASK> MASK_CC_INT;
+    typedef MP2722_Flag<MP2722_REG_CONFIG10, MP2722_MASK_BATT_LOW_MASK> MASK_BATT_LOW;
+    typedef MP2722_Flag<MP2722_REG_CONFIG10, MP2722_MASK_DEBUG_AUDIO_MASK> MASK_DEBUG_AUDIO;
+
+    /* STATUS11 (0x11) */
+    typedef MP2722_Field<MP2722_REG_STATUS11, MP2722_DPDM_STAT_MASK, MP2722_DPDM_STAT_SHIFT> DPDM_STAT;
+    typedef MP2722_Flag<MP2722_REG_STATUS11, MP2722_VINDPM_STAT_MASK> VINDPM_STAT;
+    typedef MP2722_Flag<MP2722_REG_STATUS11, MP2722_IINDPM_STAT_MASK> IINDPM_STAT;
+
+    /* STATUS12 (0x12) */
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_VIN_GD_MASK> VIN_GD;
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_VIN_RDY_MASK> VIN_RDY;
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_LEGACYCABLE_MASK> LEGACYCABLE;
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_THERM_STAT_MASK> THERM_STAT;
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_VSYS_STAT_MASK> VSYS_STAT;
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_WATCHDOG_FAULT_MASK> WATCHDOG_FAULT;
+    typedef MP2722_Flag<MP2722_REG_STATUS12, MP2722_WATCHDOG_BARK_MASK> WATCHDOG_BARK;
+
+    /* STATUS13 (0x13) */
+    typedef MP2722_Field<MP2722_REG_STATUS13, MP2722_CHG_STAT_MASK, MP2722_CHG_STAT_SHIFT> CHG_STAT;
+    typedef MP2722_Field<MP2722_REG_STATUS13, MP2722_BOOST_FAULT_MASK, MP2722_BOOST_FAULT_SHIFT> BOOST_FAULT;
+    typedef MP2722_Field<MP2722_REG_STATUS13, MP2722_CHG_FAULT_MASK, MP2722_CHG_FAULT_SHIFT> CHG_FAULT;
+
+    /* STATUS14 (0x14) */
+    typedef MP2722_Flag<MP2722_REG_STATUS14, MP2722_NTC_MISSING_MASK> NTC_MISSING;
+    typedef MP2722_Flag<MP2722_REG_STATUS14, MP2722_BATT_MISSING_MASK> BATT_MISSING;
+    typedef MP2722_Field<MP2722_REG_STATUS14, MP2722_NTC1_FAULT_MASK, MP2722_NTC1_FAULT_SHIFT> NTC1_FAULT;
+    typedef MP2722_Field<MP2722_REG_STATUS14, MP2722_NTC2_FAULT_MASK, MP2722_NTC2_FAULT_SHIFT> NTC2_FAULT;
+
+    /* STATUS15 (0x15) */
+    typedef MP2722_Field<MP2722_REG_STATUS15, MP2722_CC1_SNK_STAT_MASK, MP2722_CC1_SNK_STAT_SHIFT> CC1_SNK_STAT;
+    typedef MP2722_Field<MP2722_REG_STATUS15, MP2722_CC2_SNK_STAT_MASK, MP2722_CC2_SNK_STAT_SHIFT> CC2_SNK_STAT;
+    typedef MP2722_Field<MP2722_REG_STATUS15, MP2722_CC1_SRC_STAT_MASK, MP2722_CC1_SRC_STAT_SHIFT> CC1_SRC_STAT;
+    typedef MP2722_Field<MP2722_REG_STATUS15, MP2722_CC2_SRC_STAT_MASK, MP2722_CC2_SRC_STAT_SHIFT> CC2_SRC_STAT;
+
+    /* STATUS16 (0x16) */
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_TOPOFF_ACTIVE_MASK> TOPOFF_ACTIVE;
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_BFET_STAT_MASK> BFET_STAT;
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_BATT_LOW_STAT_MASK> BATT_LOW_STAT;
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_OTG_NEED_MASK> OTG_NEED;
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_VIN_TEST_HIGH_MASK> VIN_TEST_HIGH;
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_DEBUGACC_MASK> DEBUGACC;
+    typedef MP2722_Flag<MP2722_REG_STATUS16, MP2722_AUDIOACC_MASK> AUDIOACC;
+} // namespace MP2722_Fields
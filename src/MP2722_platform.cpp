@@ -8,28 +8,36 @@
 #include <Arduino.h>
 #include <Wire.h>
 
-static int arduino_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+int MP2722_ArduinoI2C::write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
 {
-    Wire.beginTransmission(addr);
-    Wire.write(reg);
+    TwoWire &wire = static_cast<MP2722_ArduinoI2C *>(ctx)->_wire;
+    wire.beginTransmission(addr);
+    wire.write(reg);
     for (size_t i = 0; i < len; i++)
-        Wire.write(data[i]);
-    return (Wire.endTransmission() == 0) ? 0 : -1;
+        wire.write(data[i]);
+    return (wire.endTransmission() == 0) ? 0 : -1;
 }
 
-static int arduino_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int MP2722_ArduinoI2C::read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
 {
-    Wire.beginTransmission(addr);
-    Wire.write(reg);
-    if (Wire.endTransmission(false) != 0)
+    TwoWire &wire = static_cast<MP2722_ArduinoI2C *>(ctx)->_wire;
+    wire.beginTransmission(addr);
+    wire.write(reg);
+    if (wire.endTransmission(false) != 0)
         return -1;
-    if (Wire.requestFrom(addr, (uint8_t)len) != (uint8_t)len)
+    if (wire.requestFrom(addr, (uint8_t)len) != (uint8_t)len)
         return -1;
     for (size_t i = 0; i < len; i++)
-        data[i] = Wire.read();
+        data[i] = wire.read();
     return 0;
 }
 
+MP2722_I2C MP2722_ArduinoI2C::i2c()
+{
+    MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+    return bus;
+}
+
 static void arduino_log(MP2722_LogLevel level, const char *msg)
 {
     const char *prefix;
@@ -56,10 +64,12 @@ static void arduino_log(MP2722_LogLevel level, const char *msg)
     Serial.println(msg);
 }
 
-static const MP2722_I2C _platform_i2c = {arduino_i2c_write, arduino_i2c_read};
+static MP2722_ArduinoI2C _platform_bus(Wire);
+static MP2722_I2C _platform_i2c;
 
 const MP2722_I2C *mp2722_get_platform_i2c()
 {
+    _platform_i2c = _platform_bus.i2c();
     return &_platform_i2c;
 }
 
@@ -77,28 +87,162 @@ MP2722_LogCallback mp2722_get_platform_log()
 #include <string.h>
 
 static const char *TAG = "MP2722";
-static i2c_master_dev_handle_t _dev_handle = nullptr;
+static MP2722_EspIdfI2C _platform_bus;
+static MP2722_I2C _platform_i2c;
 
 void mp2722_platform_set_i2c_handle(i2c_master_dev_handle_t handle)
 {
-    _dev_handle = handle;
+    _platform_bus.setHandle(handle);
+}
+
+esp_err_t MP2722_EspIdfI2C::enableAsync()
+{
+    if (!_handle)
+        return ESP_ERR_INVALID_STATE;
+    if (_sem)
+        return ESP_OK;
+    _sem = xSemaphoreCreateBinary();
+    if (!_sem)
+        return ESP_ERR_NO_MEM;
+    i2c_master_event_callbacks_t cbs = {};
+    cbs.on_trans_done = onTransDone;
+    esp_err_t err = i2c_master_register_event_callbacks(_handle, &cbs, this);
+    if (err != ESP_OK)
+    {
+        vSemaphoreDelete(_sem);
+        _sem = nullptr;
+    }
+    return err;
+}
+
+// Queue (callback mode) or perform one register access. Buffers must stay valid until completion.
+int MP2722_EspIdfI2C::start(bool write, uint8_t reg, uint8_t *data, size_t len)
+{
+    _reg = reg;
+    esp_err_t err;
+    if (write)
+    {
+        i2c_master_transmit_multi_buffer_info_t bufs[2] = {
+            {&_reg, 1},
+            {data, len},
+        };
+        err = i2c_master_multi_buffer_transmit(_handle, bufs, 2, _timeout);
+    }
+    else
+    {
+        err = i2c_master_transmit_receive(_handle, &_reg, 1, data, len, _timeout);
+    }
+    return (err == ESP_OK) ? 0 : -1;
+}
+
+// Block the calling task until the queued transfer completes
+int MP2722_EspIdfI2C::wait()
+{
+    TickType_t ticks = (_timeout < 0) ? portMAX_DELAY : pdMS_TO_TICKS(_timeout);
+    if (xSemaphoreTake(_sem, ticks) == pdTRUE)
+        return _result;
+
+    // Timed out but still queued: the transfer owns _reg and the caller's buffer until the I2C driver reports it
+    // (its own transfer timeout), so give it that long again before returning
+    if (xSemaphoreTake(_sem, ticks) != pdTRUE)
+        _stale = true; // Its completion is drained by idle() before the next transfer
+    return -1;
+}
+
+// True if a new transfer can be queued
+bool MP2722_EspIdfI2C::idle()
+{
+    if (!_handle || _done)
+        return false;
+    if (_stale)
+    {
+        if (xSemaphoreTake(_sem, 0) != pdTRUE)
+            return false;
+        _stale = false;
+    }
+    return true;
 }
 
-static int espidf_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+bool IRAM_ATTR MP2722_EspIdfI2C::onTransDone(i2c_master_dev_handle_t handle, const i2c_master_event_data_t *evt, void *arg)
 {
-    if (!_dev_handle)
+    MP2722_EspIdfI2C *bus = static_cast<MP2722_EspIdfI2C *>(arg);
+    int result = (evt->event == I2C_EVENT_DONE) ? 0 : -1;
+    MP2722_I2CDone done = bus->_done;
+    if (done)
+    {
+        // MP2722_I2CDone may run in interrupt context (the driver only queues the result for service())
+        bus->_done = nullptr;
+        done(bus->_doneArg, result);
+        return false;
+    }
+
+    BaseType_t woken = pdFALSE;
+    bus->_result = result;
+    xSemaphoreGiveFromISR(bus->_sem, &woken);
+    return woken == pdTRUE;
+}
+
+int MP2722_EspIdfI2C::write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+{
+    MP2722_EspIdfI2C *bus = static_cast<MP2722_EspIdfI2C *>(ctx);
+    if (!bus->idle())
         return -1;
-    uint8_t buf[len + 1];
-    buf[0] = reg;
-    memcpy(&buf[1], data, len);
-    return (i2c_master_transmit(_dev_handle, buf, len + 1, -1) == ESP_OK) ? 0 : -1;
+    if (bus->start(true, reg, const_cast<uint8_t *>(data), len) != 0)
+        return -1;
+    return bus->_sem ? bus->wait() : 0;
+}
+
+int MP2722_EspIdfI2C::read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+{
+    MP2722_EspIdfI2C *bus = static_cast<MP2722_EspIdfI2C *>(ctx);
+    if (!bus->idle())
+        return -1;
+    if (bus->start(false, reg, data, len) != 0)
+        return -1;
+    return bus->_sem ? bus->wait() : 0;
 }
 
-static int espidf_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int MP2722_EspIdfI2C::writeAsync(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len,
+                                 MP2722_I2CDone done, void *done_arg)
 {
-    if (!_dev_handle)
+    MP2722_EspIdfI2C *bus = static_cast<MP2722_EspIdfI2C *>(ctx);
+    if (!bus->idle())
+        return -1;
+    bus->_doneArg = done_arg;
+    bus->_done = done;
+    if (bus->start(true, reg, const_cast<uint8_t *>(data), len) != 0)
+    {
+        bus->_done = nullptr;
         return -1;
-    return (i2c_master_transmit_receive(_dev_handle, &reg, 1, data, len, -1) == ESP_OK) ? 0 : -1;
+    }
+    return 0;
+}
+
+int MP2722_EspIdfI2C::readAsync(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len,
+                                MP2722_I2CDone done, void *done_arg)
+{
+    MP2722_EspIdfI2C *bus = static_cast<MP2722_EspIdfI2C *>(ctx);
+    if (!bus->idle())
+        return -1;
+    bus->_doneArg = done_arg;
+    bus->_done = done;
+    if (bus->start(false, reg, data, len) != 0)
+    {
+        bus->_done = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+MP2722_I2C MP2722_EspIdfI2C::i2c()
+{
+    MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+    if (_sem)
+    {
+        bus.write_async = writeAsync;
+        bus.read_async = readAsync;
+    }
+    return bus;
 }
 
 static void espidf_log(MP2722_LogLevel level, const char *msg)
@@ -122,10 +266,9 @@ static void espidf_log(MP2722_LogLevel level, const char *msg)
     }
 }
 
-static const MP2722_I2C _platform_i2c = {espidf_i2c_write, espidf_i2c_read};
-
 const MP2722_I2C *mp2722_get_platform_i2c()
 {
+    _platform_i2c = _platform_bus.i2c();
     return &_platform_i2c;
 }
 
@@ -172,12 +315,13 @@ MP2722_LogCallback mp2722_get_platform_log()
 #include <stdio.h>
 #include <string.h>
 
-static I2C_HandleTypeDef *_hi2c = nullptr;
+static MP2722_Stm32I2C _platform_bus;
+static MP2722_I2C _platform_i2c;
 static UART_HandleTypeDef *_huart = nullptr;
 
 void mp2722_platform_set_i2c_handle(I2C_HandleTypeDef *handle)
 {
-    _hi2c = handle;
+    _platform_bus.setHandle(handle);
 }
 
 void mp2722_platform_set_uart_handle(UART_HandleTypeDef *handle)
@@ -185,26 +329,248 @@ void mp2722_platform_set_uart_handle(UART_HandleTypeDef *handle)
     _huart = handle;
 }
 
-static int stm32_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+MP2722_Stm32I2C *MP2722_Stm32I2C::_active[MP2722_STM32_MAX_BUSES] = {};
+
+MP2722_Stm32I2C::~MP2722_Stm32I2C()
+{
+    detach();
+}
+
+void MP2722_Stm32I2C::setHandle(I2C_HandleTypeDef *handle)
+{
+    detach();
+    _handle = handle;
+}
+
+MP2722_Stm32I2C *MP2722_Stm32I2C::find(I2C_HandleTypeDef *hi2c)
 {
-    if (!_hi2c)
+    for (size_t i = 0; i < MP2722_STM32_MAX_BUSES; i++)
+        if (_active[i] && _active[i]->_handle == hi2c)
+            return _active[i];
+    return nullptr;
+}
+
+// Make this backend reachable from the HAL callbacks of its handle
+bool MP2722_Stm32I2C::attach()
+{
+    MP2722_Stm32I2C *owner = find(_handle);
+    if (owner)
+        return owner == this;
+    for (size_t i = 0; i < MP2722_STM32_MAX_BUSES; i++)
+    {
+        if (!_active[i])
+        {
+            _active[i] = this;
+            registerCallbacks();
+            return true;
+        }
+    }
+    return false;
+}
+
+void MP2722_Stm32I2C::registerCallbacks()
+{
+#if defined(USE_HAL_I2C_REGISTER_CALLBACKS) && (USE_HAL_I2C_REGISTER_CALLBACKS == 1)
+    HAL_I2C_RegisterCallback(_handle, HAL_I2C_MEM_TX_COMPLETE_CB_ID, handleComplete);
+    HAL_I2C_RegisterCallback(_handle, HAL_I2C_MEM_RX_COMPLETE_CB_ID, handleComplete);
+    HAL_I2C_RegisterCallback(_handle, HAL_I2C_ERROR_CB_ID, handleError);
+    HAL_I2C_RegisterCallback(_handle, HAL_I2C_ABORT_CB_ID, handleError);
+#endif
+}
+
+void MP2722_Stm32I2C::detach()
+{
+    for (size_t i = 0; i < MP2722_STM32_MAX_BUSES; i++)
+        if (_active[i] == this)
+            _active[i] = nullptr;
+}
+
+int MP2722_Stm32I2C::start(bool write, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+{
+    if (!_handle)
+        return -1;
+    if (_aborting && !recover())
+        return -1;
+    if (_busy)
+        return -1;
+    _devAddr = (uint16_t)addr << 1; // HAL expects 8-bit (left-shifted) address
+
+    if (_mode == MP2722_Stm32Mode::POLLING)
+    {
+        HAL_StatusTypeDef ret = write
+                                    ? HAL_I2C_Mem_Write(_handle, _devAddr, reg, I2C_MEMADD_SIZE_8BIT, data, len, _timeout)
+                                    : HAL_I2C_Mem_Read(_handle, _devAddr, reg, I2C_MEMADD_SIZE_8BIT, data, len, _timeout);
+        return (ret == HAL_OK) ? 0 : -1;
+    }
+
+    if (!attach())
         return -1;
-    uint16_t dev_addr = (uint16_t)addr << 1;
-    return (HAL_I2C_Mem_Write(_hi2c, dev_addr, reg, I2C_MEMADD_SIZE_8BIT,
-                              (uint8_t *)data, len, HAL_MAX_DELAY) == HAL_OK)
-               ? 0
-               : -1;
+    _busy = true;
+    _startTick = HAL_GetTick();
+    HAL_StatusTypeDef ret;
+    if (_mode == MP2722_Stm32Mode::DMA)
+        ret = write ? HAL_I2C_Mem_Write_DMA(_handle, _devAddr, reg, I2C_MEMADD_SIZE_8BIT, data, len)
+                    : HAL_I2C_Mem_Read_DMA(_handle, _devAddr, reg, I2C_MEMADD_SIZE_8BIT, data, len);
+    else
+        ret = write ? HAL_I2C_Mem_Write_IT(_handle, _devAddr, reg, I2C_MEMADD_SIZE_8BIT, data, len)
+                    : HAL_I2C_Mem_Read_IT(_handle, _devAddr, reg, I2C_MEMADD_SIZE_8BIT, data, len);
+    if (ret != HAL_OK)
+    {
+        _busy = false;
+        return -1;
+    }
+    return 0;
 }
 
-static int stm32_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+// Sleep until the interrupt-driven transfer completes (SysTick wakes the core to check the timeout)
+int MP2722_Stm32I2C::wait()
 {
-    if (!_hi2c)
+    while (_busy)
+    {
+        if (expire(false))
+        {
+            recover();
+            return -1;
+        }
+        __WFI();
+    }
+    return _result;
+}
+
+// Completion side: report the transfer once, unless the timeout took it over
+void MP2722_Stm32I2C::finish(int result)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bool owner = _busy && !_aborting;
+    MP2722_I2CDone done = owner ? _done : nullptr;
+    if (owner)
+    {
+        _done = nullptr;
+        _result = result;
+        _busy = false;
+    }
+    __set_PRIMASK(primask);
+
+    if (done)
+        done(_doneArg, result);
+}
+
+// Timeout side: take the transfer over from the completion interrupt, false if it is not due or already reported
+bool MP2722_Stm32I2C::expire(bool async_only)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bool expired = _busy && !_aborting && (_done || !async_only) && HAL_GetTick() - _startTick >= _timeout;
+    if (expired)
+        _aborting = true;
+    __set_PRIMASK(primask);
+    return expired;
+}
+
+// HAL_I2C_Master_Abort_IT() refuses memory transfers, so stop the DMA streams and reinitialize the peripheral: no late
+// completion can touch the buffer afterwards. The transfer stays busy until the handle is READY again.
+bool MP2722_Stm32I2C::recover()
+{
+    if (_mode == MP2722_Stm32Mode::DMA)
+    {
+        if (_handle->hdmatx)
+            HAL_DMA_Abort(_handle->hdmatx);
+        if (_handle->hdmarx)
+            HAL_DMA_Abort(_handle->hdmarx);
+    }
+    HAL_I2C_DeInit(_handle);
+    if (HAL_I2C_Init(_handle) != HAL_OK || HAL_I2C_GetState(_handle) != HAL_I2C_STATE_READY)
+        return false; // Tried again by the next checkTimeout() or transfer
+    registerCallbacks(); // HAL_I2C_Init() restores the default callbacks
+
+    MP2722_I2CDone done = _done;
+    _done = nullptr;
+    _result = -1;
+    _aborting = false;
+    _busy = false;
+    if (done)
+        done(_doneArg, -1);
+    return true;
+}
+
+void MP2722_Stm32I2C::checkTimeout()
+{
+    if (_aborting || expire(true))
+        recover();
+}
+
+void MP2722_Stm32I2C::handleComplete(I2C_HandleTypeDef *hi2c)
+{
+    MP2722_Stm32I2C *bus = find(hi2c);
+    if (bus)
+        bus->finish(0);
+}
+
+void MP2722_Stm32I2C::handleError(I2C_HandleTypeDef *hi2c)
+{
+    MP2722_Stm32I2C *bus = find(hi2c);
+    if (bus)
+        bus->finish(-1);
+}
+
+int MP2722_Stm32I2C::write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+{
+    MP2722_Stm32I2C *bus = static_cast<MP2722_Stm32I2C *>(ctx);
+    if (bus->start(true, addr, reg, (uint8_t *)data, len) != 0)
         return -1;
-    uint16_t dev_addr = (uint16_t)addr << 1;
-    return (HAL_I2C_Mem_Read(_hi2c, dev_addr, reg, I2C_MEMADD_SIZE_8BIT,
-                             data, len, HAL_MAX_DELAY) == HAL_OK)
-               ? 0
-               : -1;
+    return (bus->_mode == MP2722_Stm32Mode::POLLING) ? 0 : bus->wait();
+}
+
+int MP2722_Stm32I2C::read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+{
+    MP2722_Stm32I2C *bus = static_cast<MP2722_Stm32I2C *>(ctx);
+    if (bus->start(false, addr, reg, data, len) != 0)
+        return -1;
+    return (bus->_mode == MP2722_Stm32Mode::POLLING) ? 0 : bus->wait();
+}
+
+int MP2722_Stm32I2C::writeAsync(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len,
+                                MP2722_I2CDone done, void *done_arg)
+{
+    MP2722_Stm32I2C *bus = static_cast<MP2722_Stm32I2C *>(ctx);
+    if (bus->_busy)
+        return -1;
+    bus->_doneArg = done_arg;
+    bus->_done = done;
+    if (bus->start(true, addr, reg, (uint8_t *)data, len) != 0)
+    {
+        bus->_done = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+int MP2722_Stm32I2C::readAsync(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len,
+                               MP2722_I2CDone done, void *done_arg)
+{
+    MP2722_Stm32I2C *bus = static_cast<MP2722_Stm32I2C *>(ctx);
+    if (bus->_busy)
+        return -1;
+    bus->_doneArg = done_arg;
+    bus->_done = done;
+    if (bus->start(false, addr, reg, data, len) != 0)
+    {
+        bus->_done = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+MP2722_I2C MP2722_Stm32I2C::i2c()
+{
+    MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+    if (_mode != MP2722_Stm32Mode::POLLING)
+    {
+        bus.write_async = writeAsync;
+        bus.read_async = readAsync;
+    }
+    return bus;
 }
 
 static void stm32_log(MP2722_LogLevel level, const char *msg)
@@ -234,13 +600,15 @@ static void stm32_log(MP2722_LogLevel level, const char *msg)
 
     char buf[160];
     int n = snprintf(buf, sizeof(buf), "%sMP2722: %s\r\n", prefix, msg);
-    HAL_UART_Transmit(_huart, (uint8_t *)buf, n, HAL_MAX_DELAY);
+    if (n > (int)sizeof(buf) - 1)
+        n = sizeof(buf) - 1;
+    // Bounded: a log call may run inside a driver call (use MP2722_LOG_DEFER_SIZE to move it out entirely)
+    HAL_UART_Transmit(_huart, (uint8_t *)buf, n, MP2722_STM32_LOG_TIMEOUT_MS);
 }
 
-static const MP2722_I2C _platform_i2c = {stm32_i2c_write, stm32_i2c_read};
-
 const MP2722_I2C *mp2722_get_platform_i2c()
 {
+    _platform_i2c = _platform_bus.i2c();
     return &_platform_i2c;
 }
 
@@ -260,49 +628,191 @@ MP2722_LogCallback mp2722_get_platform_log()
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 
-static int _i2c_fd = -1;
+#include "MP2722_regs.h"
 
-void mp2722_platform_set_i2c_bus(const char *device)
+MP2722_LinuxI2C::~MP2722_LinuxI2C()
 {
-    if (_i2c_fd >= 0)
-        close(_i2c_fd);
-    _i2c_fd = open(device, O_RDWR);
+    if (_ownsFd && _fd >= 0)
+        ::close(_fd);
 }
 
-void mp2722_platform_set_i2c_fd(int fd)
+bool MP2722_LinuxI2C::open(const char *device)
 {
-    _i2c_fd = fd;
+    if (_ownsFd && _fd >= 0)
+        ::close(_fd);
+    _fd = ::open(device, O_RDWR);
+    _ownsFd = (_fd >= 0);
+    _probed = false;
+    return _ownsFd;
 }
 
-static int linux_i2c_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+void MP2722_LinuxI2C::setFd(int fd)
 {
-    if (_i2c_fd < 0)
+    if (_ownsFd && _fd >= 0 && _fd != fd)
+        ::close(_fd);
+    _fd = fd;
+    _ownsFd = false;
+    _probed = false;
+}
+
+void MP2722_LinuxI2C::probe()
+{
+    _funcs = 0;
+    if (ioctl(_fd, I2C_FUNCS, &_funcs) < 0)
+        _funcs = 0;
+    _slaveAddr = -1;
+    _probed = true;
+}
+
+bool MP2722_LinuxI2C::setSlave(uint8_t addr)
+{
+    if (_slaveAddr == addr)
+        return true;
+    if (ioctl(_fd, I2C_SLAVE, addr) < 0)
+    {
+        _slaveAddr = -1;
+        return false;
+    }
+    _slaveAddr = addr;
+    return true;
+}
+
+// SMBus I2C-block transfer of up to I2C_SMBUS_BLOCK_MAX bytes, slave address must already be set
+static int linux_smbus_block(int fd, bool write, uint8_t reg, uint8_t *data, size_t len)
+{
+    union i2c_smbus_data block;
+    struct i2c_smbus_ioctl_data args;
+    block.block[0] = (uint8_t)len;
+    if (write)
+        memcpy(&block.block[1], data, len);
+    args.read_write = write ? I2C_SMBUS_WRITE : I2C_SMBUS_READ;
+    args.command = reg;
+    args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    args.data = &block;
+    if (ioctl(fd, I2C_SMBUS, &args) < 0)
         return -1;
-    if (ioctl(_i2c_fd, I2C_SLAVE, addr) < 0)
+    if (!write)
+    {
+        if (block.block[0] < len)
+            return -1;
+        memcpy(data, &block.block[1], len);
+    }
+    return 0;
+}
+
+int MP2722_LinuxI2C::write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+{
+    MP2722_LinuxI2C *bus = static_cast<MP2722_LinuxI2C *>(ctx);
+    if (bus->_fd < 0)
         return -1;
+    if (!bus->_probed)
+        bus->probe();
 
-    uint8_t buf[len + 1];
+    uint8_t buf[1 + MP2722_CONFIG_REG_COUNT + MP2722_STATUS_REG_COUNT];
+    if (len > sizeof(buf) - 1)
+        return -1;
     buf[0] = reg;
-    for (size_t i = 0; i < len; i++)
-        buf[i + 1] = data[i];
+    memcpy(&buf[1], data, len);
+
+    if (bus->_funcs & I2C_FUNC_I2C)
+    {
+        struct i2c_msg msg = {addr, 0, (uint16_t)(len + 1), buf};
+        struct i2c_rdwr_ioctl_data xfer = {&msg, 1};
+        return (ioctl(bus->_fd, I2C_RDWR, &xfer) == 1) ? 0 : -1;
+    }
+
+    if (!bus->setSlave(addr))
+        return -1;
 
-    return (write(_i2c_fd, buf, len + 1) == (ssize_t)(len + 1)) ? 0 : -1;
+    if (bus->_funcs & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK)
+    {
+        for (size_t off = 0; off < len; off += I2C_SMBUS_BLOCK_MAX)
+        {
+            size_t n = (len - off < I2C_SMBUS_BLOCK_MAX) ? len - off : I2C_SMBUS_BLOCK_MAX;
+            if (linux_smbus_block(bus->_fd, true, (uint8_t)(reg + off), &buf[1 + off], n) != 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    return (::write(bus->_fd, buf, len + 1) == (ssize_t)(len + 1)) ? 0 : -1;
 }
 
-static int linux_i2c_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int MP2722_LinuxI2C::read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
 {
-    if (_i2c_fd < 0)
+    MP2722_LinuxI2C *bus = static_cast<MP2722_LinuxI2C *>(ctx);
+    if (bus->_fd < 0)
         return -1;
-    if (ioctl(_i2c_fd, I2C_SLAVE, addr) < 0)
+    if (!bus->_probed)
+        bus->probe();
+
+    if (bus->_funcs & I2C_FUNC_I2C)
+    {
+        // Register pointer write and data read joined by a repeated start
+        struct i2c_msg msgs[2] = {
+            {addr, 0, 1, &reg},
+            {addr, I2C_M_RD, (uint16_t)len, data},
+        };
+        struct i2c_rdwr_ioctl_data xfer = {msgs, 2};
+        return (ioctl(bus->_fd, I2C_RDWR, &xfer) == 2) ? 0 : -1;
+    }
+
+    if (!bus->setSlave(addr))
         return -1;
-    if (write(_i2c_fd, &reg, 1) != 1)
+
+    if (bus->_funcs & I2C_FUNC_SMBUS_READ_I2C_BLOCK)
+    {
+        for (size_t off = 0; off < len; off += I2C_SMBUS_BLOCK_MAX)
+        {
+            size_t n = (len - off < I2C_SMBUS_BLOCK_MAX) ? len - off : I2C_SMBUS_BLOCK_MAX;
+            if (linux_smbus_block(bus->_fd, false, (uint8_t)(reg + off), &data[off], n) != 0)
+                return -1;
+        }
+        return 0;
+    }
+
+    if (::write(bus->_fd, &reg, 1) != 1)
         return -1;
-    return (read(_i2c_fd, data, len) == (ssize_t)len) ? 0 : -1;
+    return (::read(bus->_fd, data, len) == (ssize_t)len) ? 0 : -1;
+}
+
+MP2722_I2C MP2722_LinuxI2C::i2c()
+{
+    MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+    return bus;
+}
+
+MP2722_Lock MP2722_StdLock::lock()
+{
+    MP2722_Lock lock = {take, give, &_mutex};
+    return lock;
+}
+
+void MP2722_StdLock::take(void *ctx)
+{
+    static_cast<std::recursive_mutex *>(ctx)->lock();
 }
 
-static const MP2722_I2C _platform_i2c = {linux_i2c_write, linux_i2c_read};
+void MP2722_StdLock::give(void *ctx)
+{
+    static_cast<std::recursive_mutex *>(ctx)->unlock();
+}
+
+static MP2722_LinuxI2C _platform_bus;
+static MP2722_I2C _platform_i2c;
+
+void mp2722_platform_set_i2c_bus(const char *device)
+{
+    _platform_bus.open(device);
+}
+
+void mp2722_platform_set_i2c_fd(int fd)
+{
+    _platform_bus.setFd(fd);
+}
 
 static void stderr_log(MP2722_LogLevel level, const char *msg)
 {
@@ -330,7 +840,10 @@ static void stderr_log(MP2722_LogLevel level, const char *msg)
 
 const MP2722_I2C *mp2722_get_platform_i2c()
 {
-    return (_i2c_fd >= 0) ? &_platform_i2c : nullptr;
+    if (_platform_bus.fd() < 0)
+        return nullptr;
+    _platform_i2c = _platform_bus.i2c();
+    return &_platform_i2c;
 }
 
 MP2722_LogCallback mp2722_get_platform_log()
@@ -397,4 +910,27 @@ MP2722_LogCallback mp2722_get_platform_log()
     return nullptr;
 }
 
-#endif
\ No newline at end of file
+#endif
+
+// ============================================================================
+// FreeRTOS, any platform - recursive mutex for MP2722::setLock()/setBusLock()
+// ============================================================================
+#if defined(INC_FREERTOS_H)
+
+MP2722_Lock MP2722_FreeRtosLock::lock()
+{
+    MP2722_Lock lock = {take, give, _mutex};
+    return lock;
+}
+
+void MP2722_FreeRtosLock::take(void *ctx)
+{
+    xSemaphoreTakeRecursive(static_cast<SemaphoreHandle_t>(ctx), portMAX_DELAY);
+}
+
+void MP2722_FreeRtosLock::give(void *ctx)
+{
+    xSemaphoreGiveRecursive(static_cast<SemaphoreHandle_t>(ctx));
+}
+
+#endif
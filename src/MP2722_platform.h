@@ -12,6 +12,8 @@
  * @note Arduino: Uses Wire (must call Wire.begin() before use)
  * @note ESP-IDF: User must call mp2722_platform_set_i2c_handle() first
  * @note STM32 HAL: User must call mp2722_platform_set_i2c_handle() first
+ * @note To drive chargers on several buses, create one backend object per bus instead (e.g. `MP2722_LinuxI2C`)
+ *       and pass its `i2c()` to each MP2722 constructor.
  */
 const MP2722_I2C *mp2722_get_platform_i2c();
 
@@ -27,14 +29,100 @@ const MP2722_I2C *mp2722_get_platform_i2c();
  */
 MP2722_LogCallback mp2722_get_platform_log();
 
-#if defined(ESP_PLATFORM) && !defined(ARDUINO)
+#if defined(ARDUINO)
+#include <Wire.h>
+
+/**
+ * @brief Arduino Wire backend bound to one TwoWire bus
+ */
+class MP2722_ArduinoI2C
+{
+public:
+    explicit MP2722_ArduinoI2C(TwoWire &wire = Wire) : _wire(wire) {}
+
+    /**
+     * @brief I2C interface bound to this bus, to pass to the MP2722 constructor
+     */
+    MP2722_I2C i2c();
+
+private:
+    TwoWire &_wire;
+
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len);
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len);
+};
+
+#elif defined(ESP_PLATFORM)
 #include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifndef MP2722_ESPIDF_I2C_TIMEOUT_MS
+#define MP2722_ESPIDF_I2C_TIMEOUT_MS 100 // Default per-transfer timeout
+#endif
+
 /**
  * @brief Set the ESP-IDF I2C device handle
  * Must be called before mp2722_get_platform_i2c()
  */
 void mp2722_platform_set_i2c_handle(i2c_master_dev_handle_t handle);
 
+/**
+ * @brief ESP-IDF I2C master backend bound to one device handle
+ * @note Writes send the register byte and payload as two buffers of one transaction (no copy).
+ */
+class MP2722_EspIdfI2C
+{
+public:
+    explicit MP2722_EspIdfI2C(i2c_master_dev_handle_t handle = nullptr, int timeout_ms = MP2722_ESPIDF_I2C_TIMEOUT_MS)
+        : _handle(handle), _timeout(timeout_ms) {}
+
+    void setHandle(i2c_master_dev_handle_t handle) { _handle = handle; }
+
+    /**
+     * @brief Set the per-transfer timeout in milliseconds (-1 waits forever)
+     * @note In callback mode a blocking transfer that times out is given the same time again to report its completion
+     *       before failing, and the device refuses new transfers until it has.
+     */
+    void setTimeout(int timeout_ms) { _timeout = timeout_ms; }
+
+    /**
+     * @brief Switch the device to callback-driven transfers (i2c_master_register_event_callbacks)
+     * Blocking accesses then wait on a semaphore so the calling task yields, and `i2c()` also provides
+     * `write_async`/`read_async`, whose completions are signalled from the I2C interrupt.
+     * @note The bus must be created with `trans_queue_depth > 0`. Call before `i2c()`.
+     * @return ESP_OK on success
+     */
+    esp_err_t enableAsync();
+
+    /**
+     * @brief I2C interface bound to this device, to pass to the MP2722 constructor
+     */
+    MP2722_I2C i2c();
+
+private:
+    i2c_master_dev_handle_t _handle;
+    int _timeout;
+    SemaphoreHandle_t _sem = nullptr; // Non-null once callback-driven
+    uint8_t _reg = 0;                 // Register byte, must outlive a queued transfer
+    volatile int _result = 0;
+    bool _stale = false;                     // A timed-out transfer has not reported its completion yet
+    MP2722_I2CDone volatile _done = nullptr; // Pending async completion
+    void *_doneArg = nullptr;
+
+    int start(bool write, uint8_t reg, uint8_t *data, size_t len);
+    int wait();
+    bool idle();
+
+    static bool onTransDone(i2c_master_dev_handle_t handle, const i2c_master_event_data_t *evt, void *arg);
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len);
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len);
+    static int writeAsync(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len,
+                          MP2722_I2CDone done, void *done_arg);
+    static int readAsync(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len,
+                         MP2722_I2CDone done, void *done_arg);
+};
+
 #elif defined(HAL_I2C_MODULE_ENABLED) ||                                            \
     defined(STM32F0) || defined(STM32F1) || defined(STM32F2) || defined(STM32F3) || \
     defined(STM32F4) || defined(STM32F7) || defined(STM32G0) || defined(STM32G4) || \
@@ -74,9 +162,119 @@ void mp2722_platform_set_i2c_handle(I2C_HandleTypeDef *handle);
 
 /**
  * @brief Set the STM32 HAL UART handle for logging (optional)
+ * Each line is sent with `HAL_UART_Transmit()` bounded by `MP2722_STM32_LOG_TIMEOUT_MS` (longer lines are cut short).
  */
 void mp2722_platform_set_uart_handle(UART_HandleTypeDef *handle);
+
+#ifndef MP2722_STM32_I2C_TIMEOUT_MS
+#define MP2722_STM32_I2C_TIMEOUT_MS 100 // Default per-transfer timeout
+#endif
+
+#ifndef MP2722_STM32_LOG_TIMEOUT_MS
+#define MP2722_STM32_LOG_TIMEOUT_MS 20 // Longest a log line may block on the UART (about 200 chars at 115200 baud)
+#endif
+
+#ifndef MP2722_STM32_MAX_BUSES
+#define MP2722_STM32_MAX_BUSES 4 // Interrupt/DMA backends that can be active at once
+#endif
+
+/**
+ * @brief STM32 HAL transfer mode
+ */
+enum class MP2722_Stm32Mode : uint8_t
+{
+    POLLING, // HAL_I2C_Mem_Read/Write
+    IT,      // HAL_I2C_Mem_Read/Write_IT, core sleeps (WFI) while waiting
+    DMA,     // HAL_I2C_Mem_Read/Write_DMA, core sleeps (WFI) while waiting
+};
+
+/**
+ * @brief STM32 HAL backend bound to one I2C peripheral
+ * @note In IT/DMA mode the HAL completion callbacks must reach this backend. With
+ *       `USE_HAL_I2C_REGISTER_CALLBACKS` they are registered automatically, otherwise forward them:
+ * @code
+ * void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) { MP2722_Stm32I2C::handleComplete(hi2c); }
+ * void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) { MP2722_Stm32I2C::handleComplete(hi2c); }
+ * void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) { MP2722_Stm32I2C::handleError(hi2c); }
+ * @endcode
+ */
+class MP2722_Stm32I2C
+{
+public:
+    explicit MP2722_Stm32I2C(I2C_HandleTypeDef *handle = nullptr, MP2722_Stm32Mode mode = MP2722_Stm32Mode::POLLING,
+                             uint32_t timeout_ms = MP2722_STM32_I2C_TIMEOUT_MS)
+        : _handle(handle), _mode(mode), _timeout(timeout_ms) {}
+    ~MP2722_Stm32I2C();
+
+    MP2722_Stm32I2C(const MP2722_Stm32I2C &) = delete;
+    MP2722_Stm32I2C &operator=(const MP2722_Stm32I2C &) = delete;
+
+    void setHandle(I2C_HandleTypeDef *handle);
+    void setMode(MP2722_Stm32Mode mode) { _mode = mode; }
+
+    /**
+     * @brief Set the per-transfer timeout in milliseconds
+     */
+    void setTimeout(uint32_t timeout_ms) { _timeout = timeout_ms; }
+
+    /**
+     * @brief I2C interface bound to this peripheral, to pass to the MP2722 constructor
+     * In IT/DMA mode it also provides `write_async`/`read_async`, completed from the I2C interrupt.
+     */
+    MP2722_I2C i2c();
+
+    /**
+     * @brief Abort an asynchronous transfer that exceeded the timeout and report it as failed
+     * Call periodically (e.g. from the main loop) when using the driver's `*Async()` methods.
+     * @note The peripheral is reinitialized (`HAL_I2C_DeInit()`/`HAL_I2C_Init()`, DMA streams aborted first), as the
+     *       HAL cannot abort a memory transfer. No new transfer starts until that succeeds.
+     */
+    void checkTimeout();
+
+    /**
+     * @brief Forward HAL memory Tx/Rx complete callbacks here
+     */
+    static void handleComplete(I2C_HandleTypeDef *hi2c);
+
+    /**
+     * @brief Forward HAL error/abort callbacks here
+     */
+    static void handleError(I2C_HandleTypeDef *hi2c);
+
+private:
+    I2C_HandleTypeDef *_handle;
+    MP2722_Stm32Mode _mode;
+    uint32_t _timeout;
+    volatile bool _busy = false;
+    volatile bool _aborting = false; // Timed out, owned by recover() until the peripheral is READY again
+    volatile int _result = 0;
+    uint32_t _startTick = 0;
+    uint16_t _devAddr = 0;
+    MP2722_I2CDone volatile _done = nullptr; // Pending async completion
+    void *_doneArg = nullptr;
+
+    static MP2722_Stm32I2C *_active[MP2722_STM32_MAX_BUSES];
+
+    bool attach();
+    void detach();
+    void registerCallbacks();
+    int start(bool write, uint8_t addr, uint8_t reg, uint8_t *data, size_t len);
+    int wait();
+    void finish(int result);
+    bool expire(bool async_only);
+    bool recover();
+    static MP2722_Stm32I2C *find(I2C_HandleTypeDef *hi2c);
+
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len);
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len);
+    static int writeAsync(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len,
+                          MP2722_I2CDone done, void *done_arg);
+    static int readAsync(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len,
+                         MP2722_I2CDone done, void *done_arg);
+};
 #elif defined(__linux__)
+#include <mutex>
+
 /**
  * @brief Set the Linux I2C bus device (e.g., "/dev/i2c-1")
  * Must be called before mp2722_get_platform_i2c()
@@ -88,4 +286,112 @@ void mp2722_platform_set_i2c_bus(const char *device);
  * Alternative to mp2722_platform_set_i2c_bus()
  */
 void mp2722_platform_set_i2c_fd(int fd);
-#endif
\ No newline at end of file
+
+/**
+ * @brief Recursive `std::mutex` usable as `MP2722::setLock()` or `MP2722::setBusLock()`
+ */
+class MP2722_StdLock
+{
+public:
+    MP2722_Lock lock();
+
+private:
+    std::recursive_mutex _mutex;
+
+    static void take(void *ctx);
+    static void give(void *ctx);
+};
+
+/**
+ * @brief Linux i2c-dev backend bound to one bus (/dev/i2c-X)
+ * @note Each access is a single `I2C_RDWR` ioctl (write+read with repeated start) when the adapter supports
+ *       plain I2C, otherwise SMBus I2C-block transfers. The slave address ioctl is only reissued when it changes.
+ */
+class MP2722_LinuxI2C
+{
+public:
+    /**
+     * @param fd Already-opened bus file descriptor (not closed by this object), or -1 to call `open()` later
+     */
+    explicit MP2722_LinuxI2C(int fd = -1) : _fd(fd) {}
+    ~MP2722_LinuxI2C();
+
+    MP2722_LinuxI2C(const MP2722_LinuxI2C &) = delete;
+    MP2722_LinuxI2C &operator=(const MP2722_LinuxI2C &) = delete;
+
+    /**
+     * @brief Open a bus device (e.g. "/dev/i2c-1"), closing the previous one if this object opened it
+     * @return true on success
+     */
+    bool open(const char *device);
+
+    /**
+     * @brief Use an already-opened bus file descriptor (not closed by this object)
+     */
+    void setFd(int fd);
+
+    int fd() const { return _fd; }
+
+    /**
+     * @brief I2C interface bound to this bus, to pass to the MP2722 constructor
+     */
+    MP2722_I2C i2c();
+
+private:
+    int _fd;
+    bool _ownsFd = false;
+    bool _probed = false;     // _funcs valid for _fd
+    unsigned long _funcs = 0; // I2C_FUNCS adapter capabilities
+    int _slaveAddr = -1;      // Address last set with I2C_SLAVE, -1 if none
+
+    void probe();
+    bool setSlave(uint8_t addr);
+
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len);
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len);
+};
+#endif
+
+// FreeRTOS lock, on any platform where FreeRTOS.h is included before this header (always the case on ESP-IDF), or
+// with MP2722_USE_FREERTOS defined (plain FreeRTOS include layout, e.g. STM32CubeMX projects)
+#if defined(MP2722_USE_FREERTOS) && !defined(INC_FREERTOS_H)
+#include "FreeRTOS.h"
+#include "semphr.h"
+#elif defined(INC_FREERTOS_H) && !defined(SEMAPHORE_H)
+#if __has_include("freertos/semphr.h")
+#include "freertos/semphr.h"
+#else
+#include "semphr.h"
+#endif
+#endif
+
+#if defined(INC_FREERTOS_H)
+/**
+ * @brief Recursive FreeRTOS mutex usable as `MP2722::setLock()` or `MP2722::setBusLock()`
+ * Statically allocated when `configSUPPORT_STATIC_ALLOCATION` is set.
+ */
+class MP2722_FreeRtosLock
+{
+public:
+#if configSUPPORT_STATIC_ALLOCATION
+    MP2722_FreeRtosLock() : _mutex(xSemaphoreCreateRecursiveMutexStatic(&_storage)) {}
+#else
+    MP2722_FreeRtosLock() : _mutex(xSemaphoreCreateRecursiveMutex()) {}
+#endif
+    ~MP2722_FreeRtosLock() { vSemaphoreDelete(_mutex); }
+
+    MP2722_FreeRtosLock(const MP2722_FreeRtosLock &) = delete;
+    MP2722_FreeRtosLock &operator=(const MP2722_FreeRtosLock &) = delete;
+
+    MP2722_Lock lock();
+
+private:
+#if configSUPPORT_STATIC_ALLOCATION
+    StaticSemaphore_t _storage;
+#endif
+    SemaphoreHandle_t _mutex;
+
+    static void take(void *ctx);
+    static void give(void *ctx);
+};
+#endif
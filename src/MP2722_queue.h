@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Atomic accesses of naturally aligned words up to the native size, with acquire/release ordering or relaxed, and
+// fences (plain volatile accesses on non-GNU compilers, which is only safe on single-core targets)
+#if defined(__GNUC__) || defined(__clang__)
+#define MP2722_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define MP2722_ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define MP2722_ATOMIC_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define MP2722_ATOMIC_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define MP2722_ATOMIC_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define MP2722_ATOMIC_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+template <typename T>
+inline T mp2722_volatile_load(const T *p) { return *(volatile const T *)p; }
+template <typename T, typename V>
+inline void mp2722_volatile_store(T *p, V v) { *(volatile T *)p = (T)v; }
+#define MP2722_ATOMIC_LOAD(p) mp2722_volatile_load(p)
+#define MP2722_ATOMIC_STORE(p, v) mp2722_volatile_store((p), (v))
+#define MP2722_ATOMIC_LOAD_RELAXED(p) mp2722_volatile_load(p)
+#define MP2722_ATOMIC_STORE_RELAXED(p, v) mp2722_volatile_store((p), (v))
+#define MP2722_ATOMIC_FENCE_ACQUIRE() ((void)0)
+#define MP2722_ATOMIC_FENCE_RELEASE() ((void)0)
+#endif
+
+// Code reachable from an interrupt handler. On ESP-IDF it must sit in IRAM, since handlers registered with
+// ESP_INTR_FLAG_IRAM also run while the flash cache is disabled: out-of-line functions take MP2722_ISR_ATTR, header
+// functions MP2722_ISR_INLINE so they are always inlined into such a caller
+#if defined(ESP_PLATFORM)
+#include "esp_attr.h"
+#define MP2722_ISR_ATTR IRAM_ATTR
+#define MP2722_ISR_INLINE inline __attribute__((always_inline))
+#else
+#define MP2722_ISR_ATTR
+#define MP2722_ISR_INLINE inline
+#endif
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer.
+ *
+ * Exactly one context pushes (e.g. an ISR) and exactly one other context pops (e.g. a task). Neither side ever
+ * blocks or disables interrupts.
+ *
+ * @tparam T Item type (copied in and out)
+ * @tparam Size Capacity, a power of two in [2, 128]
+ */
+template <typename T, uint8_t Size>
+class MP2722_SpscQueue
+{
+    static_assert(Size >= 2 && Size <= 128 && (Size & (Size - 1)) == 0, "Size must be a power of two in [2, 128]");
+
+public:
+    /**
+     * @brief Producer side: append an item
+     * @return false if the queue is full (item dropped)
+     */
+    MP2722_ISR_INLINE bool push(const T &item)
+    {
+        uint8_t head = _head; // Only the producer writes _head
+        uint8_t tail = MP2722_ATOMIC_LOAD(&_tail);
+        if ((uint8_t)(head - tail) == Size)
+            return false;
+        _items[head & (Size - 1)] = item;
+        MP2722_ATOMIC_STORE(&_head, (uint8_t)(head + 1));
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: remove the oldest item
+     * @return false if the queue is empty
+     */
+    bool pop(T &item)
+    {
+        uint8_t tail = _tail; // Only the consumer writes _tail
+        uint8_t head = MP2722_ATOMIC_LOAD(&_head);
+        if (head == tail)
+            return false;
+        item = _items[tail & (Size - 1)];
+        MP2722_ATOMIC_STORE(&_tail, (uint8_t)(tail + 1));
+        return true;
+    }
+
+    bool empty() const { return MP2722_ATOMIC_LOAD(&_head) == MP2722_ATOMIC_LOAD(&_tail); }
+
+private:
+    T _items[Size];
+    uint8_t _head = 0; // Next slot to write (free-running, wraps at 256)
+    uint8_t _tail = 0; // Next slot to read (free-running, wraps at 256)
+};
+
+#ifndef MP2722_SEQLOCK_TRIES
+#define MP2722_SEQLOCK_TRIES 4 // Copies a seqlock reader attempts before giving up on a concurrent write
+#endif
+
+/**
+ * @brief Sequence lock: one writer publishes a small value that any number of readers copy without locks.
+ *
+ * The writer never waits. A reader that overlaps a write sees an odd or changed sequence number and retries, at most
+ * MP2722_SEQLOCK_TRIES times: a writer preempted mid-write by the reader (same core, lower priority) would never finish
+ * while the reader spins, so the reader gives up and takes the value from elsewhere.
+ *
+ * @tparam T Trivially copyable value
+ */
+template <typename T>
+class MP2722_Seqlock
+{
+public:
+    /**
+     * @brief Writer side: publish a new value (one writer at a time)
+     */
+    void store(const T &value)
+    {
+        uint32_t seq = MP2722_ATOMIC_LOAD_RELAXED(&_seq);
+        MP2722_ATOMIC_STORE_RELAXED(&_seq, seq + 1); // Odd: write in progress
+        MP2722_ATOMIC_FENCE_RELEASE();
+        const uint8_t *src = reinterpret_cast<const uint8_t *>(&value);
+        for (size_t i = 0; i < sizeof(T); i++)
+            MP2722_ATOMIC_STORE_RELAXED(&_data[i], src[i]);
+        MP2722_ATOMIC_STORE(&_seq, seq + 2);
+    }
+
+    /**
+     * @brief Reader side: copy the latest value
+     * @return false if nothing was published yet, or every try overlapped a write (`value` is then undefined)
+     */
+    bool load(T &value) const
+    {
+        uint8_t *dst = reinterpret_cast<uint8_t *>(&value);
+        for (uint8_t tries = 0; tries < MP2722_SEQLOCK_TRIES; tries++)
+        {
+            uint32_t seq = MP2722_ATOMIC_LOAD(&_seq);
+            if (seq == 0)
+                return false;
+            if (seq & 1)
+                continue;
+            for (size_t i = 0; i < sizeof(T); i++)
+                dst[i] = MP2722_ATOMIC_LOAD_RELAXED(&_data[i]);
+            MP2722_ATOMIC_FENCE_ACQUIRE();
+            if (MP2722_ATOMIC_LOAD_RELAXED(&_seq) == seq)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    uint32_t _seq = 0; // Even: stable, odd: write in progress, 0: never written
+    uint8_t _data[sizeof(T)] = {};
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "MP2722_status.h"
+
+/**
+ * @brief One flight recorder entry: a status snapshot and when it was first seen
+ */
+struct MP2722_RecorderEntry
+{
+    uint32_t timestamp; // MP2722::setClock() time of the read
+    RawStatus status;   // STATUS11h~16h
+};
+
+/**
+ * @brief Flight recorder of status snapshots, on caller-provided storage (no heap).
+ *
+ * Every status read is offered to the recorder; a snapshot is stored only when it differs from the previous one, so
+ * the ring covers state changes rather than polls. When a fault bit sets (WATCHDOG_FAULT, CHG_FAULT, BOOST_FAULT,
+ * NTC_MISSING, BATT_MISSING), the recorder keeps `post_trigger` more entries and then freezes, preserving the window
+ * around the fault until `rearm()`.
+ *
+ * Usually declared as `MP2722_FlightRecorderBuffer<N>` and attached with `MP2722::attachRecorder()`.
+ */
+class MP2722_FlightRecorder
+{
+public:
+    /**
+     * @param entries      Storage for `capacity` entries
+     * @param capacity     Number of entries (1 to 255)
+     * @param post_trigger Entries kept after the fault entry before freezing (rest of the ring is pre-fault history)
+     */
+    MP2722_FlightRecorder(MP2722_RecorderEntry *entries, uint8_t capacity, uint8_t post_trigger)
+        : _entries(entries), _capacity(capacity), _post(post_trigger < capacity ? post_trigger : capacity - 1) {}
+
+    /**
+     * @brief Offer a snapshot (called by the driver on every status read)
+     */
+    void record(uint32_t timestamp, const RawStatus &status)
+    {
+        if (_frozen)
+            return;
+
+        const MP2722_RecorderEntry *last = _count ? &_entries[(_head + _capacity - 1) % _capacity] : nullptr;
+        if (last && memcmp(last->status.regs, status.regs, MP2722_STATUS_REG_COUNT) == 0)
+            return;
+
+        bool fault = last && newFault(last->status, status);
+
+        MP2722_RecorderEntry &entry = _entries[_head];
+        entry.timestamp = timestamp;
+        entry.status = status;
+        _head = (_head + 1) % _capacity;
+        if (_count < _capacity)
+            _count++;
+
+        if (_triggered)
+        {
+            _triggerAge++;
+            if (--_remaining == 0)
+                _frozen = true;
+        }
+        else if (fault)
+        {
+            _triggered = true;
+            _triggerAge = 0;
+            _remaining = _post;
+            _frozen = (_post == 0);
+        }
+    }
+
+    /** @brief Number of stored entries */
+    uint8_t size() const { return _count; }
+
+    /** @brief Entry `i`, oldest first */
+    const MP2722_RecorderEntry &operator[](uint8_t i) const
+    {
+        return _entries[(_head + _capacity - _count + i) % _capacity];
+    }
+
+    /** @brief True once a fault was recorded */
+    bool triggered() const { return _triggered; }
+
+    /** @brief True once the post-fault window is complete (recording stopped) */
+    bool frozen() const { return _frozen; }
+
+    /** @brief Index (oldest first) of the entry where the fault appeared, valid if `triggered()` */
+    uint8_t triggerIndex() const { return _count - 1 - _triggerAge; }
+
+    /** @brief Clear the history and resume recording */
+    void rearm()
+    {
+        _head = 0;
+        _count = 0;
+        _triggered = false;
+        _frozen = false;
+        _triggerAge = 0;
+        _remaining = 0;
+    }
+
+private:
+    MP2722_RecorderEntry *_entries;
+    uint8_t _capacity;
+    uint8_t _post;
+    uint8_t _head = 0;       // Next entry to write
+    uint8_t _count = 0;      // Stored entries
+    uint8_t _triggerAge = 0; // Entries stored after the fault entry
+    uint8_t _remaining = 0;  // Entries still to store before freezing
+    bool _triggered = false;
+    bool _frozen = false;
+
+    // True if a fault bit is set in `cur` that was clear in `prev`
+    static bool newFault(const RawStatus &prev, const RawStatus &cur)
+    {
+        using namespace MP2722_Fields;
+        return (newBits(prev, cur, MP2722_REG_STATUS12) & WATCHDOG_FAULT::mask) ||
+               (newBits(prev, cur, MP2722_REG_STATUS13) & (CHG_FAULT::mask | BOOST_FAULT::mask)) ||
+               (newBits(prev, cur, MP2722_REG_STATUS14) & (NTC_MISSING::mask | BATT_MISSING::mask));
+    }
+
+    static uint8_t newBits(const RawStatus &prev, const RawStatus &cur, uint8_t reg)
+    {
+        return cur.reg(reg) & ~prev.reg(reg);
+    }
+};
+
+/**
+ * @brief Flight recorder with built-in storage for `N` entries
+ *
+ * @tparam N    Capacity in entries
+ * @tparam Post Entries kept after a fault (default: half of the ring)
+ */
+template <uint8_t N, uint8_t Post = N / 2>
+class MP2722_FlightRecorderBuffer : public MP2722_FlightRecorder
+{
+    static_assert(N > 0, "Recorder needs at least one entry");
+
+public:
+    MP2722_FlightRecorderBuffer() : MP2722_FlightRecorder(_storage, N, Post) {}
+
+private:
+    MP2722_RecorderEntry _storage[N];
+};
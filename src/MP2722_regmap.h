@@ -0,0 +1,112 @@
+// Generated from docs/REG_MAP_CONFIG.csv and docs/REG_MAP_STATUS.csv by tools/gen_regmap.py. Do not edit.
+#pragma once
+
+#include "MP2722_regs.h"
+
+// Power-on values of CONFIG00h~10h
+#define MP2722_POR_VALUES 0x0B, 0x04, 0xD9, 0x43, 0x36, 0x18, 0x24, 0x1E, 0x7F, 0x0B, 0x24, 0x10, 0x51, 0x60, 0x99, 0x00, 0x40
+
+// Bits reset to their POR value by a watchdog expiry (WTD Reset: Yes), CONFIG00h~10h
+#define MP2722_WTD_RESET_BITS 0x08, 0x00, 0x3F, 0xFF, 0xF0, 0xC0, 0x07, 0xFF, 0x38, 0x7F, 0x2F, 0x03, 0x13, 0x0F, 0xFF, 0x7F, 0x00
+
+// Host-writable bits (R/W), REG00h~16h
+#define MP2722_WRITABLE_BITS 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x3F, 0x1F, 0x7F, 0xFF, 0xFF, 0x7F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+
+// Every named field as X(name, register, mask, shift), register then bit order (reserved bits left out)
+#define MP2722_REG_FIELD_LIST(X) \
+    X(REG_RST, 0x00, 0x80, 7) \
+    X(EN_STAT_IB, 0x00, 0x40, 6) \
+    X(EN_PG_NTC2, 0x00, 0x20, 5) \
+    X(LOCK_CHG, 0x00, 0x10, 4) \
+    X(HOLDOFF_TMR, 0x00, 0x08, 3) \
+    X(SW_FREQ, 0x00, 0x06, 1) \
+    X(EN_VIN_TRK, 0x00, 0x01, 0) \
+    X(IIN_MODE, 0x01, 0xE0, 5) \
+    X(IIN_LIM, 0x01, 0x1F, 0) \
+    X(VPRE, 0x02, 0xC0, 6) \
+    X(ICC, 0x02, 0x3F, 0) \
+    X(IPRE, 0x03, 0xF0, 4) \
+    X(ITERM, 0x03, 0x0F, 0) \
+    X(VRECHG, 0x04, 0x80, 7) \
+    X(ITRICKLE, 0x04, 0x70, 4) \
+    X(VIN_LIM, 0x04, 0x0F, 0) \
+    X(TOPOFF_TMR, 0x05, 0xC0, 6) \
+    X(VBATT, 0x05, 0x3F, 0) \
+    X(VIN_OVP, 0x06, 0xC0, 6) \
+    X(SYS_MIN, 0x06, 0x38, 3) \
+    X(TREG, 0x06, 0x07, 0) \
+    X(IB_EN, 0x07, 0x80, 7) \
+    X(WATCHDOG_RST, 0x07, 0x40, 6) \
+    X(WATCHDOG, 0x07, 0x30, 4) \
+    X(EN_TERM, 0x07, 0x08, 3) \
+    X(EN_TMR2X, 0x07, 0x04, 2) \
+    X(CHG_TIMER, 0x07, 0x03, 0) \
+    X(BATTFET_DIS, 0x08, 0x80, 7) \
+    X(BATTFET_DLY, 0x08, 0x40, 6) \
+    X(BATTFET_RST_EN, 0x08, 0x20, 5) \
+    X(OLIM, 0x08, 0x18, 3) \
+    X(VBOOST, 0x08, 0x07, 0) \
+    X(CC_CFG, 0x09, 0x70, 4) \
+    X(AUTOOTG, 0x09, 0x08, 3) \
+    X(EN_BOOST, 0x09, 0x04, 2) \
+    X(EN_BUCK, 0x09, 0x02, 1) \
+    X(EN_CHG, 0x09, 0x01, 0) \
+    X(AUTODPDM, 0x0A, 0x20, 5) \
+    X(FORCEDPDM, 0x0A, 0x10, 4) \
+    X(RP_CFG, 0x0A, 0x0C, 2) \
+    X(FORCE_CC, 0x0A, 0x03, 0) \
+    X(HVEN, 0x0B, 0x10, 4) \
+    X(HVUP, 0x0B, 0x08, 3) \
+    X(HVDOWN, 0x0B, 0x04, 2) \
+    X(HVREQ, 0x0B, 0x03, 0) \
+    X(NTC1_ACTION, 0x0C, 0x40, 6) \
+    X(NTC2_ACTION, 0x0C, 0x20, 5) \
+    X(BATT_OVP_EN, 0x0C, 0x10, 4) \
+    X(BATT_LOW, 0x0C, 0x0C, 2) \
+    X(BOOST_STP_EN, 0x0C, 0x02, 1) \
+    X(BOOST_OTP_EN, 0x0C, 0x01, 0) \
+    X(WARM_ACT, 0x0D, 0xC0, 6) \
+    X(COOL_ACT, 0x0D, 0x30, 4) \
+    X(JEITA_VSET, 0x0D, 0x0C, 2) \
+    X(JEITA_ISET, 0x0D, 0x03, 0) \
+    X(VHOT, 0x0E, 0xC0, 6) \
+    X(VWARM, 0x0E, 0x30, 4) \
+    X(VCOOL, 0x0E, 0x0C, 2) \
+    X(VCOLD, 0x0E, 0x03, 0) \
+    X(VIN_SRC_EN, 0x0F, 0x40, 6) \
+    X(IVIN_SRC, 0x0F, 0x3C, 2) \
+    X(VIN_TEST, 0x0F, 0x03, 0) \
+    X(MASK_THERM, 0x10, 0x20, 5) \
+    X(MASK_DPM, 0x10, 0x10, 4) \
+    X(MASK_TOPOFF, 0x10, 0x08, 3) \
+    X(MASK_CC_INT, 0x10, 0x04, 2) \
+    X(MASK_BATT_LOW, 0x10, 0x02, 1) \
+    X(MASK_DEBUG_AUDIO, 0x10, 0x01, 0) \
+    X(DPDM_STAT, 0x11, 0xF0, 4) \
+    X(VINDPM_STAT, 0x11, 0x02, 1) \
+    X(IINDPM_STAT, 0x11, 0x01, 0) \
+    X(VIN_GD, 0x12, 0x40, 6) \
+    X(VIN_RDY, 0x12, 0x20, 5) \
+    X(LEGACYCABLE, 0x12, 0x10, 4) \
+    X(THERM_STAT, 0x12, 0x08, 3) \
+    X(VSYS_STAT, 0x12, 0x04, 2) \
+    X(WATCHDOG_FAULT, 0x12, 0x02, 1) \
+    X(WATCHDOG_BARK, 0x12, 0x01, 0) \
+    X(CHG_STAT, 0x13, 0xE0, 5) \
+    X(BOOST_FAULT, 0x13, 0x1C, 2) \
+    X(CHG_FAULT, 0x13, 0x03, 0) \
+    X(NTC_MISSING, 0x14, 0x80, 7) \
+    X(BATT_MISSING, 0x14, 0x40, 6) \
+    X(NTC1_FAULT, 0x14, 0x38, 3) \
+    X(NTC2_FAULT, 0x14, 0x07, 0) \
+    X(CC1_SNK_STAT, 0x15, 0xC0, 6) \
+    X(CC2_SNK_STAT, 0x15, 0x30, 4) \
+    X(CC1_SRC_STAT, 0x15, 0x0C, 2) \
+    X(CC2_SRC_STAT, 0x15, 0x03, 0) \
+    X(TOPOFF_ACTIVE, 0x16, 0x40, 6) \
+    X(BFET_STAT, 0x16, 0x20, 5) \
+    X(BATT_LOW_STAT, 0x16, 0x10, 4) \
+    X(OTG_NEED, 0x16, 0x08, 3) \
+    X(VIN_TEST_HIGH, 0x16, 0x04, 2) \
+    X(DEBUGACC, 0x16, 0x02, 1) \
+    X(AUDIOACC, 0x16, 0x01, 0)
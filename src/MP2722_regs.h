@@ -31,6 +31,10 @@
 #define MP2722_REG_STATUS15 0x15
 #define MP2722_REG_STATUS16 0x16
 
+#define MP2722_CONFIG_REG_COUNT 17 // CONFIG00h~10h
+#define MP2722_STATUS_REG_COUNT 6  // STATUS11h~16h
+#define MP2722_REG_COUNT 23        // REG00h~16h
+
 /* CONFIG0 (0x00) */
 #define MP2722_REG_RST_MASK (1 << 7)
 #define MP2722_EN_STAT_IB_MASK (1 << 6)
@@ -60,7 +64,7 @@
 /* CONFIG3 (0x03) - Pre-Charge & Termination */
 #define MP2722_IPRE_MASK (0xF0) // Bits [7:4]
 #define MP2722_IPRE_SHIFT 4
-#define MP2722_IPRE_STEP 80
+#define MP2722_IPRE_STEP 40
 #define MP2722_IPRE_BASE 80
 #define MP2722_ITERM_MASK (0x0F) // Bits [3:0]
 #define MP2722_ITERM_SHIFT 0
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MP2722_LATENCY_BUCKETS 16 // Latency histogram buckets, the last one also counts everything longer
+
+/**
+ * @brief Counters and latency histogram of one kind of bus transfer (reads or writes)
+ */
+struct MP2722_BusOpStats
+{
+    uint32_t count = 0;    // Transfers attempted
+    uint32_t bytes = 0;    // Payload bytes of successful transfers
+    uint32_t failures = 0; // Transfers the platform reported as failed
+    int lastError = 0;     // Platform return code of the last failure (0 if none)
+
+    /**
+     * Transfers by duration in timer ticks (see `MP2722::attachBusStats()`): bucket 0 counts 0 ticks, bucket `i`
+     * counts [2^(i-1), 2^i) ticks. Empty without a timer.
+     */
+    uint32_t latency[MP2722_LATENCY_BUCKETS] = {};
+    uint32_t maxLatency = 0; // Longest transfer in ticks
+
+    /** @brief Record one transfer (called by the driver) */
+    void record(int result, size_t len, uint32_t ticks, bool timed)
+    {
+        count++;
+        if (result == 0)
+        {
+            bytes += len;
+        }
+        else
+        {
+            failures++;
+            lastError = result;
+        }
+
+        if (!timed)
+            return;
+        latency[bucket(ticks)]++;
+        if (ticks > maxLatency)
+            maxLatency = ticks;
+    }
+
+    /** @brief Histogram bucket of a duration */
+    static uint8_t bucket(uint32_t ticks)
+    {
+        uint8_t i = 0;
+        while (ticks && i < MP2722_LATENCY_BUCKETS - 1)
+        {
+            ticks >>= 1;
+            i++;
+        }
+        return i;
+    }
+};
+
+/**
+ * @brief Bus statistics of one driver instance, on caller-provided storage (see `MP2722::attachBusStats()`)
+ */
+struct MP2722_BusStats
+{
+    MP2722_BusOpStats read = {};
+    MP2722_BusOpStats write = {};
+    uint32_t writesAvoided = 0; // Register writes skipped because the value was already in place
+    uint32_t retries = 0;       // Failed transfers attempted again (see `MP2722::setRetryPolicy()`)
+
+    void reset() { *this = MP2722_BusStats(); }
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "MP2722_defs.h"
+#include "MP2722_regs.h"
+#include "MP2722_fields.h"
+
+/**
+ * @brief Status field groups for partial reads (bitmask), one per status register
+ */
+enum MP2722_StatusFields : uint8_t
+{
+    MP2722_STATUS_INPUT = 1 << 0,   // REG11h: DPDM_STAT, VINDPM_STAT, IINDPM_STAT
+    MP2722_STATUS_POWER = 1 << 1,   // REG12h: VIN_GD, VIN_RDY, LEGACYCABLE, THERM_STAT, VSYS_STAT, WATCHDOG_FAULT/BARK
+    MP2722_STATUS_CHARGER = 1 << 2, // REG13h: CHG_STAT, BOOST_FAULT, CHG_FAULT
+    MP2722_STATUS_NTC = 1 << 3,     // REG14h: NTC_MISSING, BATT_MISSING, NTC1_FAULT, NTC2_FAULT
+    MP2722_STATUS_TYPEC = 1 << 4,   // REG15h: CC1/CC2 sink and source state
+    MP2722_STATUS_MISC = 1 << 5,    // REG16h: TOPOFF_ACTIVE, BFET_STAT, BATT_LOW_STAT, OTG_NEED, VIN_TEST_HIGH, DEBUGACC, AUDIOACC
+    MP2722_STATUS_ALL = (1 << MP2722_STATUS_REG_COUNT) - 1,
+};
+
+/**
+ * @brief Raw status snapshot: the 6 bytes of STATUS11h~16h as read from the PMIC.
+ *
+ * Each accessor extracts one field on demand (a mask and a shift, usually inlined away), so checking a single field
+ * costs nothing more and history buffers only need 6 bytes per entry. Use `toPowerStatus()` when the fully decoded
+ * struct is more convenient.
+ */
+struct RawStatus
+{
+    uint8_t regs[MP2722_STATUS_REG_COUNT];
+
+    /** @brief Value of status register `address` (MP2722_REG_STATUS11 to MP2722_REG_STATUS16) */
+    constexpr uint8_t reg(uint8_t address) const { return regs[address - MP2722_REG_STATUS11]; }
+
+    /** @brief Code of any status field descriptor (e.g. `get<MP2722_Fields::CHG_STAT>()`) */
+    template <typename Field>
+    constexpr uint8_t get() const { return Field::get(reg(Field::reg)); }
+
+    /** @brief State of any status flag descriptor (e.g. `flag<MP2722_Fields::VIN_GD>()`) */
+    template <typename Flag>
+    constexpr bool flag() const { return Flag::decode(reg(Flag::reg)); }
+
+    // --- Register 11 ---
+    constexpr LegacyInputSrcType legacySrcType() const { return static_cast<LegacyInputSrcType>(get<MP2722_Fields::DPDM_STAT>()); }
+    constexpr bool vindpm() const { return flag<MP2722_Fields::VINDPM_STAT>(); }
+    constexpr bool iindpm() const { return flag<MP2722_Fields::IINDPM_STAT>(); }
+    constexpr bool inputDpmRegulation() const { return vindpm() || iindpm(); }
+
+    // --- Register 12 ---
+    constexpr bool vinGood() const { return flag<MP2722_Fields::VIN_GD>(); }
+    constexpr bool vinReady() const { return flag<MP2722_Fields::VIN_RDY>(); }
+    constexpr bool chargerReady() const { return vinGood() && vinReady(); }
+    constexpr bool legacyCable() const { return flag<MP2722_Fields::LEGACYCABLE>(); }
+    constexpr bool thermalRegulation() const { return flag<MP2722_Fields::THERM_STAT>(); }
+    constexpr bool vsysRegulation() const { return flag<MP2722_Fields::VSYS_STAT>(); }
+    constexpr bool faultWatchdog() const { return flag<MP2722_Fields::WATCHDOG_FAULT>(); }
+    constexpr bool watchdogBark() const { return flag<MP2722_Fields::WATCHDOG_BARK>(); }
+
+    // --- Register 13 ---
+    constexpr ChargerStatus chargerStatus() const { return static_cast<ChargerStatus>(get<MP2722_Fields::CHG_STAT>()); }
+    constexpr BoostFault boostFault() const { return static_cast<BoostFault>(get<MP2722_Fields::BOOST_FAULT>()); }
+    constexpr ChargerFault chargerFault() const { return static_cast<ChargerFault>(get<MP2722_Fields::CHG_FAULT>()); }
+
+    // --- Register 14 ---
+    constexpr bool faultNtc() const { return flag<MP2722_Fields::NTC_MISSING>(); }
+    constexpr bool faultBattery() const { return flag<MP2722_Fields::BATT_MISSING>(); }
+    constexpr NTCState ntc1State() const { return static_cast<NTCState>(get<MP2722_Fields::NTC1_FAULT>()); }
+    constexpr NTCState ntc2State() const { return static_cast<NTCState>(get<MP2722_Fields::NTC2_FAULT>()); }
+
+    // --- Register 15 ---
+    constexpr CCSinkStatus cc1SnkStat() const { return static_cast<CCSinkStatus>(get<MP2722_Fields::CC1_SNK_STAT>()); }
+    constexpr CCSinkStatus cc2SnkStat() const { return static_cast<CCSinkStatus>(get<MP2722_Fields::CC2_SNK_STAT>()); }
+    constexpr CCSourceStatus cc1SrcStat() const { return static_cast<CCSourceStatus>(get<MP2722_Fields::CC1_SRC_STAT>()); }
+    constexpr CCSourceStatus cc2SrcStat() const { return static_cast<CCSourceStatus>(get<MP2722_Fields::CC2_SRC_STAT>()); }
+
+    // --- Register 16 ---
+    constexpr bool topoffActive() const { return flag<MP2722_Fields::TOPOFF_ACTIVE>(); }
+    constexpr bool bfetStat() const { return flag<MP2722_Fields::BFET_STAT>(); }
+    constexpr bool battLowStat() const { return flag<MP2722_Fields::BATT_LOW_STAT>(); }
+    constexpr bool otgNeed() const { return flag<MP2722_Fields::OTG_NEED>(); }
+    constexpr bool vinTestHigh() const { return flag<MP2722_Fields::VIN_TEST_HIGH>(); }
+    constexpr bool debugAcc() const { return flag<MP2722_Fields::DEBUGACC>(); }
+    constexpr bool audioAcc() const { return flag<MP2722_Fields::AUDIOACC>(); }
+
+    /**
+     * @brief Fully decoded copy, for code written against PowerStatus
+     */
+    PowerStatus toPowerStatus() const
+    {
+        PowerStatus status;
+        status.legacy_src_type = legacySrcType();
+        status.legacy_cable = legacyCable();
+        status.vin_good = vinGood();
+        status.vin_ready = vinReady();
+        status.charger_ready = chargerReady();
+        status.vsys_regulation = vsysRegulation();
+        status.thermal_regulation = thermalRegulation();
+        status.input_dpm_regulation = inputDpmRegulation();
+        status.fault_watchdog = faultWatchdog();
+        status.charger_status = chargerStatus();
+        status.charger_fault = chargerFault();
+        status.boost_fault = boostFault();
+        status.fault_battery = faultBattery();
+        status.fault_ntc = faultNtc();
+        status.ntc1_state = ntc1State();
+        status.ntc2_state = ntc2State();
+        status.cc1_snk_stat = cc1SnkStat();
+        status.cc2_snk_stat = cc2SnkStat();
+        status.cc1_src_stat = cc1SrcStat();
+        status.cc2_src_stat = cc2SrcStat();
+        status.topoff_active = topoffActive();
+        status.bfet_stat = bfetStat();
+        status.batt_low_stat = battLowStat();
+        status.otg_need = otgNeed();
+        status.vin_test_high = vinTestHigh();
+        status.debug_acc = debugAcc();
+        status.audio_acc = audioAcc();
+        return status;
+    }
+};
@@ -0,0 +1,201 @@
+// Bus cost benchmark: I2C transactions, bytes and modelled wire time of each API against the simulator, checked
+// against the budgets below, plus host CPU time of status decoding and logging (informative only).
+// Exits with a failure if any API goes over its budget.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include "MP2722.h"
+#include "mp2722_sim.h"
+
+// Counts the traffic of the wrapped bus and models its duration on the wire
+struct BusMeter
+{
+    MP2722_I2C inner;
+    uint32_t transactions = 0;
+    uint32_t bytes = 0; // Address, register and data bytes
+    uint32_t bits = 0;  // Including ACKs, START/repeated START and STOP
+
+    MP2722_I2C i2c()
+    {
+        MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+        return bus;
+    }
+
+    void clear()
+    {
+        transactions = 0;
+        bytes = 0;
+        bits = 0;
+    }
+
+    double wireUs(uint32_t hz) const { return bits * 1e6 / hz; }
+
+    // S, address+W, register, data..., P
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        BusMeter *m = static_cast<BusMeter *>(ctx);
+        m->transactions++;
+        m->bytes += 2 + len;
+        m->bits += 9 * (2 + len) + 2;
+        return m->inner.write(m->inner.ctx, addr, reg, data, len);
+    }
+
+    // S, address+W, register, Sr, address+R, data..., P
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+    {
+        BusMeter *m = static_cast<BusMeter *>(ctx);
+        m->transactions++;
+        m->bytes += 3 + len;
+        m->bits += 9 * (3 + len) + 3;
+        return m->inner.read(m->inner.ctx, addr, reg, data, len);
+    }
+};
+
+typedef MP2722_Result (*Call)(MP2722 &pmic);
+
+struct Budget
+{
+    const char *name;
+    bool cache;  // Register cache enabled
+    Call setup;  // Run before measuring (nullptr: init())
+    Call call;   // Measured call
+    uint8_t max_transactions;
+    uint8_t max_bytes;
+};
+
+static MP2722_Result setCharge(MP2722 &pmic)
+{
+    MP2722_Result ret = pmic.init();
+    if (ret == MP2722_Result::OK)
+        ret = pmic.setChargeVoltage(4200);
+    if (ret == MP2722_Result::OK)
+        ret = pmic.setChargeCurrent(1000);
+    return ret;
+}
+
+static MP2722_Result noSetup(MP2722 &)
+{
+    return MP2722_Result::OK;
+}
+
+static constexpr MP2722_Config profile = MP2722_Config::porDefaults()
+                                             .set<MP2722_Fields::ICC>(1000)
+                                             .set<MP2722_Fields::VBATT_REG>(4350)
+                                             .set<MP2722_Fields::EN_CHG>(false);
+
+static const Budget budgets[] = {
+    // name, cache, setup, call, max transactions, max bytes
+    {"init()", false, noSetup, [](MP2722 &p) { return p.init(); }, 2, 26},
+    {"init() cached", true, noSetup, [](MP2722 &p) { return p.init(); }, 2, 26},
+    {"setChargeCurrent()", false, nullptr, [](MP2722 &p) { return p.setChargeCurrent(1000); }, 2, 7},
+    {"setChargeCurrent() cached", true, nullptr, [](MP2722 &p) { return p.setChargeCurrent(1000); }, 1, 3},
+    {"setChargeVoltage()", false, nullptr, [](MP2722 &p) { return p.setChargeVoltage(4350); }, 2, 7},
+    {"setChargeVoltage() cached", true, nullptr, [](MP2722 &p) { return p.setChargeVoltage(4350); }, 1, 3},
+    {"setInputCurrentLimit()", false, nullptr, [](MP2722 &p) { return p.setInputCurrentLimit(1500); }, 2, 7},
+    {"setInputCurrentLimit() cached", true, nullptr, [](MP2722 &p) { return p.setInputCurrentLimit(1500); }, 2, 7},
+    {"setCharging()", false, setCharge, [](MP2722 &p) { return p.setCharging(true); }, 2, 7},
+    {"setCharging() cached", true, setCharge, [](MP2722 &p) { return p.setCharging(true); }, 1, 3},
+    {"setBoost()", true, nullptr, [](MP2722 &p) { return p.setBoost(true); }, 1, 3},
+    {"setAutoOTG()", true, nullptr, [](MP2722 &p) { return p.setAutoOTG(false); }, 1, 3},
+    {"setStatAsAnalogIB()", true, nullptr, [](MP2722 &p) { return p.setStatAsAnalogIB(true); }, 2, 6},
+    {"forceDpDmDetection()", true, nullptr, [](MP2722 &p) { return p.forceDpDmDetection(); }, 1, 3},
+    {"setWatchdog()", true, nullptr, [](MP2722 &p) { return p.setWatchdog(WatchdogTimer::SEC_160); }, 1, 3},
+    {"setChargeTimer()", true, nullptr, [](MP2722 &p) { return p.setChargeTimer(ChargeTimer::HOURS_15); }, 1, 3},
+    {"applyConfig()", false, nullptr, [](MP2722 &p) { return p.applyConfig(profile); }, 1, 19},
+    {"applyConfig() verified", false, nullptr, [](MP2722 &p) { return p.applyConfig(profile, true); }, 2, 39},
+    {"dumpRegisters()", false, nullptr, [](MP2722 &p) { MP2722_RegisterDump d; return p.dumpRegisters(d); }, 1, 26},
+    {"getStatus()", false, nullptr, [](MP2722 &p) { PowerStatus s; return p.getStatus(s); }, 1, 9},
+    {"getStatus(CHARGER)", false, nullptr, [](MP2722 &p) { RawStatus s; return p.getStatus(MP2722_STATUS_CHARGER, s); }, 1, 4},
+    {"watchdogKick()", false, nullptr, [](MP2722 &p) { return p.watchdogKick(); }, 2, 7},
+    {"watchdogKick() cached", true, nullptr, [](MP2722 &p) { return p.watchdogKick(); }, 1, 3},
+};
+
+static int runBudgets()
+{
+    int failures = 0;
+    printf("%-32s %4s %6s %10s %10s %s\n", "API", "tx", "bytes", "100kHz us", "400kHz us", "budget");
+    for (const Budget &b : budgets)
+    {
+        MP2722Sim sim;
+        BusMeter meter;
+        meter.inner = sim.i2c();
+        MP2722 pmic(meter.i2c());
+        pmic.setRegisterCache(b.cache);
+
+        MP2722_Result ret = b.setup ? b.setup(pmic) : pmic.init();
+        meter.clear();
+        if (ret == MP2722_Result::OK)
+            ret = b.call(pmic);
+
+        bool ok = ret == MP2722_Result::OK && meter.transactions <= b.max_transactions && meter.bytes <= b.max_bytes;
+        printf("%-32s %4u %6u %10.1f %10.1f %u/%u%s\n", b.name, (unsigned)meter.transactions, (unsigned)meter.bytes,
+               meter.wireUs(100000), meter.wireUs(400000), b.max_transactions, b.max_bytes,
+               ret != MP2722_Result::OK ? "  FAILED CALL" : (ok ? "" : "  OVER BUDGET"));
+        failures += !ok;
+    }
+    return failures;
+}
+
+template <typename F>
+static double nsPerOp(uint32_t iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+        f(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static volatile uint32_t sink;
+
+static void nullLog(MP2722_LogLevel, const char *message)
+{
+    sink = sink + (uint8_t)message[0];
+}
+
+static void runCpu()
+{
+    const uint32_t n = 200000;
+    printf("\n%-32s %10s\n", "CPU (host)", "ns/op");
+
+    RawStatus raw = {{0x12, 0x64, 0x60, 0x00, 0x05, 0x41}};
+    printf("%-32s %10.1f\n", "RawStatus::toPowerStatus()", nsPerOp(n, [&](uint32_t i) {
+               raw.regs[2] = (uint8_t)(i << 5);
+               PowerStatus s = raw.toPowerStatus();
+               sink = sink + (uint8_t)s.charger_status;
+           }));
+    printf("%-32s %10.1f\n", "RawStatus::chargerStatus()", nsPerOp(n, [&](uint32_t i) {
+               raw.regs[2] = (uint8_t)(i << 5);
+               sink = sink + (uint8_t)raw.chargerStatus();
+           }));
+
+    MP2722Sim sim;
+    MP2722 pmic(sim.i2c());
+    pmic.setRegisterCache(true);
+    pmic.init();
+    printf("%-32s %10.1f\n", "getStatus() incl. events (sim)", nsPerOp(n, [&](uint32_t i) {
+               sim.setStatus(MP2722_REG_STATUS13, (uint8_t)(i << 5));
+               PowerStatus s;
+               uint32_t events;
+               pmic.getStatus(s, events);
+               sink = sink + events;
+           }));
+    printf("%-32s %10.1f\n", "setChargeCurrent() no log", nsPerOp(n, [&](uint32_t i) {
+               pmic.setChargeCurrent(i & 1 ? 1000 : 500);
+           }));
+    pmic.setLogCallback(MP2722_LogLevel::DEBUG, nullLog);
+    printf("%-32s %10.1f\n", "setChargeCurrent() DEBUG log", nsPerOp(n, [&](uint32_t i) {
+               pmic.setChargeCurrent(i & 1 ? 1000 : 500);
+           }));
+}
+
+int main()
+{
+    int failures = runBudgets();
+    runCpu();
+    if (failures)
+        printf("\n%d API(s) over budget\n", failures);
+    return failures ? 1 : 0;
+}
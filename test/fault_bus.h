@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "MP2722.h"
+
+/**
+ * @brief Fault-injecting `MP2722_I2C` wrapper for host tests, on a deterministic schedule:
+ * - every `nak_every`th transfer fails without reaching the wrapped bus
+ * - every `spike_every`th transfer takes `spike_us` longer
+ * - every `flip_every`th transfer that goes through has bit `flip_bit` of its first data byte inverted (on the wire,
+ *   so a write stores the flipped value and a read returns it)
+ *
+ * Time is virtual: each transfer advances the shared clock by `transfer_us` (plus any spike), and `delay()` advances it
+ * by the requested time, so `micros()`, `millis()` and `delay()` can be given to the driver as its clock, bus
+ * statistics timer and retry wait. A period of 0 disables that fault.
+ */
+class FaultBus
+{
+public:
+    struct Faults
+    {
+        uint32_t nak_every;
+        uint32_t spike_every;
+        uint32_t spike_us;
+        uint32_t flip_every;
+        uint8_t flip_bit;
+    };
+
+    explicit FaultBus(const MP2722_I2C &inner, uint32_t transfer_us = 100) : _inner(inner), _transferUs(transfer_us) {}
+
+    /** @brief Bus with the faults, to pass to the MP2722 constructor */
+    MP2722_I2C i2c()
+    {
+        MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+        return bus;
+    }
+
+    /** @brief Start a new schedule (the transfer count restarts) */
+    void inject(const Faults &faults)
+    {
+        _faults = faults;
+        transfers = 0;
+    }
+
+    // Virtual clock shared by every FaultBus
+    static uint32_t micros() { return _nowUs; }
+    static uint32_t millis() { return _nowUs / 1000; }
+    static void delay(uint32_t ms) { _nowUs += ms * 1000; }
+
+    // Transfers seen and faults injected since the last `inject()` (reset freely)
+    uint32_t transfers = 0;
+    uint32_t naks = 0;
+    uint32_t spikes = 0;
+    uint32_t flips = 0;
+
+private:
+    MP2722_I2C _inner;
+    uint32_t _transferUs;
+    Faults _faults = {};
+    static inline uint32_t _nowUs = 0;
+
+    static bool due(uint32_t count, uint32_t every) { return every && count % every == 0; }
+
+    // Time and NAK of the next transfer, true if it goes through
+    bool begin()
+    {
+        transfers++;
+        _nowUs += _transferUs;
+        if (due(transfers, _faults.spike_every))
+        {
+            _nowUs += _faults.spike_us;
+            spikes++;
+        }
+        if (due(transfers, _faults.nak_every))
+        {
+            naks++;
+            return false;
+        }
+        return true;
+    }
+
+    bool flip(size_t len)
+    {
+        if (!len || !due(transfers, _faults.flip_every))
+            return false;
+        flips++;
+        return true;
+    }
+
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+    {
+        FaultBus *bus = static_cast<FaultBus *>(ctx);
+        if (!bus->begin())
+            return -1;
+        if (!bus->flip(len))
+            return bus->_inner.write(bus->_inner.ctx, addr, reg, data, len);
+
+        uint8_t flipped[MP2722_CONFIG_REG_COUNT + MP2722_STATUS_REG_COUNT];
+        if (len > sizeof(flipped))
+            return -1;
+        memcpy(flipped, data, len);
+        flipped[0] ^= (uint8_t)(1 << bus->_faults.flip_bit);
+        return bus->_inner.write(bus->_inner.ctx, addr, reg, flipped, len);
+    }
+
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+    {
+        FaultBus *bus = static_cast<FaultBus *>(ctx);
+        if (!bus->begin())
+            return -1;
+        int ret = bus->_inner.read(bus->_inner.ctx, addr, reg, data, len);
+        if (ret == 0 && bus->flip(len))
+            data[0] ^= (uint8_t)(1 << bus->_faults.flip_bit);
+        return ret;
+    }
+};
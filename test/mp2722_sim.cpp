@@ -0,0 +1,278 @@
+#include "mp2722_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Split a CSV line in place into trimmed fields, returns the number of fields
+static int splitCsv(char *line, char **fields, int max)
+{
+    int count = 0;
+    char *p = line;
+    while (count < max)
+    {
+        char *end = strchr(p, ',');
+        if (end)
+            *end = '\0';
+
+        while (*p == ' ' || *p == '\t')
+            p++;
+        char *last = p + strlen(p);
+        while (last > p && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r' || last[-1] == '\n'))
+            *--last = '\0';
+        fields[count++] = p;
+
+        if (!end)
+            break;
+        p = end + 1;
+    }
+    return count;
+}
+
+MP2722Sim::MP2722Sim(const char *reg_map_csv)
+{
+    _loaded = loadRegMap(reg_map_csv);
+    powerOnReset();
+}
+
+// Bit rows follow their "REGxxh" header row: "Bit, Name, POR, WTD Reset, Type, Description, ..."
+bool MP2722Sim::loadRegMap(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+
+    char line[1024];
+    int reg = -1;
+    int bits = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#')
+            continue;
+
+        char *fields[6];
+        int count = splitCsv(line, fields, 6);
+        if (count < 5)
+            continue;
+
+        if (strncmp(fields[0], "REG", 3) == 0)
+        {
+            reg = (int)strtol(fields[0] + 3, nullptr, 16);
+            continue;
+        }
+        if (reg < 0 || reg >= REG_COUNT || fields[0][0] < '0' || fields[0][0] > '7')
+            continue;
+
+        uint8_t bit = (uint8_t)(1 << (fields[0][0] - '0'));
+        if (strcmp(fields[2], "1") == 0)
+            _por[reg] |= bit;
+        if (strcmp(fields[3], "Yes") == 0)
+            _wtd[reg] |= bit;
+        if (strcmp(fields[4], "R") == 0)
+            _ro[reg] |= bit;
+        bits++;
+    }
+    fclose(f);
+    return bits == MP2722_CONFIG_REG_COUNT * 8;
+}
+
+MP2722_I2C MP2722Sim::i2c()
+{
+    MP2722_I2C bus = {write, read, this, nullptr, nullptr};
+    return bus;
+}
+
+void MP2722Sim::powerOnReset()
+{
+    memset(_regs, 0, sizeof(_regs));
+    memcpy(_regs, _por, MP2722_CONFIG_REG_COUNT);
+    _kickedAt = _now;
+}
+
+void MP2722Sim::setStatus(uint8_t reg, uint8_t value)
+{
+    if (reg < MP2722_REG_STATUS11 || reg > MP2722_REG_STATUS16 || _regs[reg] == value)
+        return;
+    _regs[reg] = value;
+    pulseInt();
+}
+
+void MP2722Sim::script(const Step *steps, size_t count)
+{
+    _script = steps;
+    _scriptLen = count;
+    _scriptPos = 0;
+}
+
+void MP2722Sim::advance(uint32_t ms)
+{
+    const uint32_t end = _now + ms;
+    for (;;)
+    {
+        // Jump to the next scripted step or watchdog deadline, whichever comes first
+        uint32_t next = end;
+        if (_scriptPos < _scriptLen)
+        {
+            uint32_t at = _script[_scriptPos].at_ms < _now ? _now : _script[_scriptPos].at_ms;
+            if (at < next)
+                next = at;
+        }
+        uint32_t period = watchdogPeriod();
+        if (period)
+        {
+            uint32_t bark = _kickedAt + period / 4 * 3;
+            if (!(_regs[MP2722_REG_STATUS12] & MP2722_WATCHDOG_BARK_MASK) && bark < next)
+                next = bark;
+            if (_kickedAt + period < next)
+                next = _kickedAt + period;
+        }
+        _now = next;
+
+        while (_scriptPos < _scriptLen && _script[_scriptPos].at_ms <= _now)
+        {
+            setStatus(_script[_scriptPos].reg, _script[_scriptPos].value);
+            _scriptPos++;
+        }
+        checkWatchdog();
+
+        if (_now == end)
+            break;
+    }
+}
+
+void MP2722Sim::setIntCallback(IntCallback callback, void *user)
+{
+    _intCallback = callback;
+    _intUser = user;
+}
+
+uint32_t MP2722Sim::watchdogPeriod() const
+{
+    uint8_t code = (_regs[MP2722_REG_CONFIG7] & MP2722_WATCHDOG_MASK) >> MP2722_WATCHDOG_SHIFT;
+    return code ? 20000UL << code : 0;
+}
+
+void MP2722Sim::checkWatchdog()
+{
+    uint32_t period = watchdogPeriod();
+    if (!period)
+        return;
+
+    uint32_t elapsed = _now - _kickedAt;
+    uint8_t status = _regs[MP2722_REG_STATUS12];
+    if (elapsed >= period / 4 * 3)
+        status |= MP2722_WATCHDOG_BARK_MASK;
+    if (elapsed >= period)
+    {
+        status |= MP2722_WATCHDOG_FAULT_MASK;
+        for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+            _regs[reg] = (_regs[reg] & ~_wtd[reg]) | (_por[reg] & _wtd[reg]);
+        _kickedAt = _now;
+    }
+    setStatus(MP2722_REG_STATUS12, status);
+}
+
+// New value of a LOCK_CHG protected field: only reductions are accepted (`mask` selects the field bits)
+uint8_t MP2722Sim::lockedField(uint8_t old_val, uint8_t new_val, uint8_t mask) const
+{
+    return ((new_val & mask) <= (old_val & mask)) ? (new_val & mask) : (old_val & mask);
+}
+
+void MP2722Sim::writeReg(uint8_t reg, uint8_t value)
+{
+    if (reg >= MP2722_CONFIG_REG_COUNT)
+        return; // Status registers are read-only
+
+    uint8_t old_val = _regs[reg];
+    value = (value & ~_ro[reg]) | (old_val & _ro[reg]);
+
+    if (reg == MP2722_REG_CONFIG0 && (value & MP2722_REG_RST_MASK))
+    {
+        memcpy(_regs, _por, MP2722_CONFIG_REG_COUNT);
+        return;
+    }
+
+    if (_regs[MP2722_REG_CONFIG0] & MP2722_LOCK_CHG_MASK)
+    {
+        switch (reg)
+        {
+        case MP2722_REG_CONFIG2:
+            value = (value & ~MP2722_ICC_MASK) | lockedField(old_val, value, MP2722_ICC_MASK);
+            break;
+        case MP2722_REG_CONFIG3:
+            value = (value & ~MP2722_IPRE_MASK) | lockedField(old_val, value, MP2722_IPRE_MASK);
+            break;
+        case MP2722_REG_CONFIG5:
+            value = (value & ~MP2722_VBATT_REG_MASK) | lockedField(old_val, value, MP2722_VBATT_REG_MASK);
+            break;
+        case MP2722_REG_CONFIGD:
+        {
+            // Higher JEITA codes are the lower (reduced) settings
+            uint8_t jeita = MP2722_JEITA_VSET_MASK | MP2722_JEITA_ISET_MASK;
+            uint8_t inv_old = old_val ^ jeita, inv_new = value ^ jeita;
+            uint8_t vset = lockedField(inv_old, inv_new, MP2722_JEITA_VSET_MASK);
+            uint8_t iset = lockedField(inv_old, inv_new, MP2722_JEITA_ISET_MASK);
+            value = (value & ~jeita) | ((vset | iset) ^ jeita);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (reg == MP2722_REG_CONFIG7 && (value & MP2722_WATCHDOG_RST_MASK))
+    {
+        _kickedAt = _now;
+        _regs[MP2722_REG_STATUS12] &= ~(MP2722_WATCHDOG_FAULT_MASK | MP2722_WATCHDOG_BARK_MASK);
+        value &= ~MP2722_WATCHDOG_RST_MASK;
+    }
+    if (reg == MP2722_REG_CONFIGA)
+        value &= ~MP2722_FORCEDPDM_MASK;
+    if (reg == MP2722_REG_CONFIGB)
+        value &= ~(MP2722_HVUP_MASK | MP2722_HVDOWN_MASK);
+
+    _regs[reg] = value;
+}
+
+void MP2722Sim::pulseInt()
+{
+    intPulses++;
+    if (_intCallback)
+        _intCallback(_intUser);
+}
+
+int MP2722Sim::write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+{
+    MP2722Sim *sim = static_cast<MP2722Sim *>(ctx);
+    if (addr != MP2722_I2C_ADDRESS)
+        return -1; // NACK
+    if (sim->_failNext)
+    {
+        sim->_failNext--;
+        return -1;
+    }
+
+    sim->writes++;
+    sim->bytesWritten += len;
+    for (size_t i = 0; i < len; i++)
+        sim->writeReg((uint8_t)(reg + i), data[i]);
+    return 0;
+}
+
+int MP2722Sim::read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+{
+    MP2722Sim *sim = static_cast<MP2722Sim *>(ctx);
+    if (addr != MP2722_I2C_ADDRESS)
+        return -1;
+    if (sim->_failNext)
+    {
+        sim->_failNext--;
+        return -1;
+    }
+
+    sim->reads++;
+    sim->bytesRead += len;
+    for (size_t i = 0; i < len; i++)
+        data[i] = sim->_regs[(uint8_t)(reg + i)];
+    return 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "MP2722.h"
+
+/**
+ * @brief Register-level MP2722 model for host tests and benchmarks, usable as an `MP2722_I2C` bus.
+ *
+ * Power-on values, watchdog-reset fields and read-only bits come from docs/REG_MAP_CONFIG.csv. Modelled rules:
+ * - REG_RST restores every configuration register to its POR value; REG_RST, WATCHDOG_RST, FORCEDPDM, HVUP and HVDOWN
+ *   read back as 0
+ * - Read-only configuration bits and the status registers (11h~16h) ignore writes
+ * - With LOCK_CHG set, VBATT, ICC, IPRE, JEITA_VSET and JEITA_ISET only accept lower values
+ * - The watchdog (WATCHDOG[1:0] period, restarted by WATCHDOG_RST) raises WATCHDOG_BARK at 3/4 of the period, then on
+ *   expiry resets the WTD fields to POR and raises WATCHDOG_FAULT. Both clear when the watchdog is kicked.
+ * - Status changes, scripted or from the watchdog, pulse the INT line callback
+ *
+ * Time only advances through `advance()`.
+ */
+class MP2722Sim
+{
+public:
+    /** @brief Scripted status change: `reg` (11h~16h) becomes `value` at `at_ms` */
+    struct Step
+    {
+        uint32_t at_ms;
+        uint8_t reg;
+        uint8_t value;
+    };
+
+    typedef void (*IntCallback)(void *user);
+
+    /**
+     * @param reg_map_csv Path of docs/REG_MAP_CONFIG.csv
+     */
+    explicit MP2722Sim(const char *reg_map_csv = MP2722_REG_MAP_CSV);
+
+    /** @brief True if the register map was parsed */
+    bool loaded() const { return _loaded; }
+
+    /** @brief Bus bound to this simulator, to pass to the MP2722 constructor */
+    MP2722_I2C i2c();
+
+    /** @brief Power cycle: POR configuration, cleared status, watchdog restarted */
+    void powerOnReset();
+
+    uint8_t reg(uint8_t addr) const { return _regs[addr]; }
+    uint8_t porValue(uint8_t addr) const { return _por[addr]; }
+    uint8_t watchdogResetMask(uint8_t addr) const { return _wtd[addr]; }
+
+    /** @brief Set a status register as the PMIC would (pulses INT if it changed) */
+    void setStatus(uint8_t reg, uint8_t value);
+
+    /** @brief Status changes applied by `advance()` when their time comes (steps sorted by time, not copied) */
+    void script(const Step *steps, size_t count);
+
+    /** @brief Move time forward: scripted steps and watchdog, in time order */
+    void advance(uint32_t ms);
+
+    uint32_t now() const { return _now; }
+
+    void setIntCallback(IntCallback callback, void *user = nullptr);
+
+    /** @brief Fail the next `count` transfers (bus errors) */
+    void failNext(uint32_t count) { _failNext = count; }
+
+    // Bus traffic since construction (reset freely)
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t bytesRead = 0;
+    uint32_t bytesWritten = 0;
+    uint32_t intPulses = 0;
+
+private:
+    static const uint16_t REG_COUNT = MP2722_CONFIG_REG_COUNT + MP2722_STATUS_REG_COUNT;
+
+    uint8_t _regs[256] = {};
+    uint8_t _por[REG_COUNT] = {};
+    uint8_t _wtd[REG_COUNT] = {}; // Bits reset to POR on watchdog expiry
+    uint8_t _ro[REG_COUNT] = {};  // Read-only configuration bits
+    bool _loaded = false;
+
+    uint32_t _now = 0;
+    uint32_t _kickedAt = 0;
+    const Step *_script = nullptr;
+    size_t _scriptLen = 0;
+    size_t _scriptPos = 0;
+    IntCallback _intCallback = nullptr;
+    void *_intUser = nullptr;
+    uint32_t _failNext = 0;
+
+    bool loadRegMap(const char *path);
+    uint32_t watchdogPeriod() const;
+    void checkWatchdog();
+    void writeReg(uint8_t reg, uint8_t value);
+    uint8_t lockedField(uint8_t old_val, uint8_t new_val, uint8_t mask) const;
+    void pulseInt();
+
+    static int write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len);
+    static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len);
+};
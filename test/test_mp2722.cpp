@@ -1,14 +1,21 @@
 #include <catch2/catch_test_macros.hpp>
 #include "MP2722.h"
+#include "mp2722_sim.h"
+#include "fault_bus.h"
 #include <cstring>
+#include <algorithm>
+#include <string>
 #include <vector>
 
 // Mock register file
 static uint8_t mock_regs[256] = {};
 static std::vector<std::pair<uint8_t, uint8_t>> write_log;
+static int read_count = 0;
+static int write_count = 0;
 
-int mock_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+int mock_write(void *, uint8_t, uint8_t reg, const uint8_t *data, size_t len)
 {
+    write_count++;
     for (size_t i = 0; i < len; i++)
     {
         mock_regs[reg + i] = data[i];
@@ -17,14 +24,59 @@ int mock_write(uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
     return 0;
 }
 
-int mock_read(uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+int mock_read(void *, uint8_t, uint8_t reg, uint8_t *data, size_t len)
 {
+    read_count++;
     for (size_t i = 0; i < len; i++)
         data[i] = mock_regs[reg + i];
     return 0;
 }
 
-static MP2722_I2C mock_i2c = {mock_write, mock_read};
+static MP2722_I2C mock_i2c = {mock_write, mock_read, nullptr, nullptr, nullptr};
+
+// Async transfers are queued and completed by the test, like an ISR would
+struct PendingTransfer
+{
+    bool write;
+    uint8_t reg;
+    uint8_t *data;
+    size_t len;
+    MP2722_I2CDone done;
+    void *arg;
+};
+static std::vector<PendingTransfer> pending;
+
+int mock_write_async(void *, uint8_t, uint8_t reg, const uint8_t *data, size_t len, MP2722_I2CDone done, void *arg)
+{
+    pending.push_back({true, reg, const_cast<uint8_t *>(data), len, done, arg});
+    return 0;
+}
+
+int mock_read_async(void *, uint8_t, uint8_t reg, uint8_t *data, size_t len, MP2722_I2CDone done, void *arg)
+{
+    pending.push_back({false, reg, data, len, done, arg});
+    return 0;
+}
+
+// Complete the oldest pending transfer, returns false if none
+static bool complete_one(int result = 0)
+{
+    if (pending.empty())
+        return false;
+    PendingTransfer t = pending.front();
+    pending.erase(pending.begin());
+    if (result == 0)
+    {
+        if (t.write)
+            mock_write(nullptr, 0, t.reg, t.data, t.len);
+        else
+            mock_read(nullptr, 0, t.reg, t.data, t.len);
+    }
+    t.done(t.arg, result);
+    return true;
+}
+
+static MP2722_I2C mock_async_i2c = {mock_write, mock_read, nullptr, mock_write_async, mock_read_async};
 
 TEST_CASE("Init succeeds with valid I2C")
 {
@@ -63,3 +115,1180 @@ TEST_CASE("Charge current is clamped")
     // Above maximum
     REQUIRE(pmic.setChargeCurrent(9999) == MP2722_Result::OK);
 }
+
+
+TEST_CASE("Register cache turns setters into single writes")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+
+    read_count = 0;
+    write_count = 0;
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(read_count == 0);
+    REQUIRE(write_count == 1);
+
+    // Same value again: no bus access at all
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(read_count == 0);
+    REQUIRE(write_count == 1);
+
+    // CONFIG1 is updated by the PMIC itself, so it is always read back
+    REQUIRE(pmic.setInputCurrentLimit(1500) == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+
+    // Register reset invalidates the cache, next setter resynchronizes with one burst read
+    REQUIRE(pmic.reset() == MP2722_Result::OK);
+    read_count = 0;
+    write_count = 0;
+    REQUIRE(pmic.setChargeVoltage(4200) == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+    REQUIRE(write_count == 1);
+}
+
+TEST_CASE("Init costs one burst read and at most two burst writes")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    read_count = 0;
+    write_count = 0;
+
+    MP2722 pmic(mock_i2c);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+    REQUIRE(write_count >= 1);
+    REQUIRE(write_count <= 2);
+
+    REQUIRE((mock_regs[MP2722_REG_CONFIG9] & MP2722_EN_CHG_MASK) == 0);
+    REQUIRE((mock_regs[MP2722_REG_CONFIG9] & MP2722_EN_BUCK_MASK) != 0);
+    REQUIRE((mock_regs[MP2722_REG_CONFIG9] & MP2722_AUTOOTG_MASK) != 0);
+    REQUIRE((mock_regs[MP2722_REG_CONFIGA] & MP2722_AUTODPDM_MASK) != 0);
+    REQUIRE((mock_regs[MP2722_REG_CONFIGC] & MP2722_BOOST_STP_EN_MASK) != 0);
+}
+
+TEST_CASE("Transaction merges neighbouring registers into burst writes")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    mock_regs[MP2722_REG_CONFIG3] = 0x5A;
+    MP2722 pmic(mock_i2c);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+
+    read_count = 0;
+    write_count = 0;
+    write_log.clear();
+
+    MP2722::Transaction tx = pmic.beginTransaction();
+    tx.update(MP2722_REG_CONFIG2, MP2722_ICC_MASK, 0x0C)
+        .update(MP2722_REG_CONFIG4, MP2722_VIN_LIM_MASK, 0x03)
+        .update(MP2722_REG_CONFIG5, MP2722_VBATT_REG_MASK, 0x18)
+        .update(MP2722_REG_CONFIGE, MP2722_VHOT_MASK, MP2722_VHOT_MASK);
+    REQUIRE(tx.commit() == MP2722_Result::OK);
+
+    // One read spanning CONFIG2~E, one burst for CONFIG2~5 (CONFIG3 rewritten unchanged), one for CONFIGE
+    REQUIRE(read_count == 1);
+    REQUIRE(write_count == 2);
+    REQUIRE(write_log.size() == 5);
+    REQUIRE(mock_regs[MP2722_REG_CONFIG3] == 0x5A);
+    REQUIRE(mock_regs[MP2722_REG_CONFIG5] == 0x18);
+
+    // Reused for a second batch: the registers are read again, not merged with the first batch's values
+    mock_regs[MP2722_REG_CONFIG3] = 0xA5;
+    read_count = 0;
+    REQUIRE(tx.update(MP2722_REG_CONFIG3, 0x01, 0x00).commit() == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+    REQUIRE(mock_regs[MP2722_REG_CONFIG3] == 0xA4);
+
+    // Nothing staged, or nothing changed: no bus access
+    read_count = 0;
+    write_count = 0;
+    REQUIRE(tx.commit() == MP2722_Result::OK);
+    REQUIRE(pmic.beginTransaction().update(MP2722_REG_STATUS11, 0xFF, 0).commit() == MP2722_Result::INVALID_ARG);
+    REQUIRE(read_count == 0);
+    REQUIRE(write_count == 0);
+}
+
+TEST_CASE("Field descriptors encode at compile time")
+{
+    using namespace MP2722_Fields;
+
+    static_assert(ICC::encode(1000) == 12, "1000mA rounds down to 12 * 80mA");
+    static_assert(ICC::encode(10) == ICC::encode(80), "Below range clamps to the minimum");
+    static_assert(ICC::encode(9999) == 62, "Above range clamps to 5000mA");
+    static_assert(VBATT_REG::encode(4200) == 0x18, "4.2V default code");
+    static_assert(VBATT_REG::encode(4700) == 40, "VBATT_REG clamps at 4.6V");
+    static_assert(IIN_LIM::encode(500) == 0x04, "500mA default code");
+    static_assert(IPRE::decode(0x40) == 240, "IPRE default 240mA");
+    static_assert(TREG::encode(100) == 0x04, "100C default code");
+    static_assert(EN_CHG::encode(true) == MP2722_EN_CHG_MASK, "Flag encode");
+    static_assert(!ICC::inRange(5100) && VBATT_REG::inRange(3600), "Range checks");
+
+    // Reciprocal division matches a real division over the whole range
+    int mismatches = 0;
+    for (uint16_t v = 0; v < 6000; v++)
+    {
+        mismatches += VBATT_REG::code(v) != (VBATT_REG::clamp(v) - 3600) / 25;
+        mismatches += ICC::code(v) != ICC::clamp(v) / 80;
+        mismatches += VIN_LIM::code(v) != (VIN_LIM::clamp(v) - 3880) / 80;
+    }
+    REQUIRE(mismatches == 0);
+
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    pmic.init();
+    REQUIRE(pmic.setInputCurrentLimit(1550) == MP2722_Result::OK);
+    REQUIRE((mock_regs[MP2722_REG_CONFIG1] & MP2722_IIN_LIM_MASK) == 14);
+}
+
+static void async_done(MP2722_Result result, void *user)
+{
+    *static_cast<MP2722_Result *>(user) = result;
+}
+
+TEST_CASE("Async API advances on transfer completion without blocking")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    pending.clear();
+    MP2722 pmic(mock_async_i2c);
+
+    MP2722_Result result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.initAsync(async_done, &result) == MP2722_Result::OK);
+    REQUIRE(pmic.isBusy());
+    REQUIRE(pmic.init() != MP2722_Result::OK); // Blocking calls are rejected meanwhile
+    REQUIRE(pending.size() == 1);
+    REQUIRE(!pending[0].write);
+
+    // Completions only queue the result, service() runs the next step and the callback
+    REQUIRE(complete_one());
+    REQUIRE(pending.empty());
+    REQUIRE(result == MP2722_Result::NOT_FOUND);
+    REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(pending.size() == 1);
+
+    int transfers = 1;
+    while (complete_one() && pmic.service() == MP2722_Result::OK)
+        transfers++;
+    REQUIRE(transfers <= 3); // One burst read, one or two burst writes
+    REQUIRE(result == MP2722_Result::OK);
+    REQUIRE(!pmic.isBusy());
+    REQUIRE((mock_regs[MP2722_REG_CONFIG9] & MP2722_EN_BUCK_MASK) != 0);
+
+    result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.setChargeCurrentAsync(1000, async_done, &result) == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeVoltageAsync(4200, async_done, &result) == MP2722_Result::INVALID_STATE); // Busy
+    while (complete_one())
+        pmic.service();
+    REQUIRE(result == MP2722_Result::OK);
+    REQUIRE((mock_regs[MP2722_REG_CONFIG2] & MP2722_ICC_MASK) == 12);
+
+    mock_regs[MP2722_REG_STATUS13] = 0b10100000; // CHARGE_DONE
+    PowerStatus status{};
+    result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.getStatusAsync(status, async_done, &result) == MP2722_Result::OK);
+    REQUIRE(complete_one(-1)); // Bus error
+    REQUIRE(pmic.isBusy());
+    REQUIRE(pmic.tick(0) == MP2722_Result::OK); // Serviced by the scheduler too
+    REQUIRE(result == MP2722_Result::FAIL);
+    REQUIRE(pmic.getStatusAsync(status, async_done, &result) == MP2722_Result::OK);
+    REQUIRE(complete_one());
+    REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(result == MP2722_Result::OK);
+    REQUIRE(status.charger_status == ChargerStatus::CHARGE_DONE);
+}
+
+TEST_CASE("Async API falls back to blocking transfers")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+
+    MP2722_Result result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.initAsync(async_done, &result) == MP2722_Result::OK);
+    REQUIRE(result == MP2722_Result::OK);
+    REQUIRE(!pmic.isBusy());
+
+    REQUIRE(pmic.setChargingAsync(true, async_done, &result) == MP2722_Result::INVALID_STATE);
+}
+
+// Per-bus register files, selected through the I2C context pointer
+struct MockBus
+{
+    uint8_t regs[256];
+};
+
+static int bus_write(void *ctx, uint8_t, uint8_t reg, const uint8_t *data, size_t len)
+{
+    memcpy(&static_cast<MockBus *>(ctx)->regs[reg], data, len);
+    return 0;
+}
+
+static int bus_read(void *ctx, uint8_t, uint8_t reg, uint8_t *data, size_t len)
+{
+    memcpy(data, &static_cast<MockBus *>(ctx)->regs[reg], len);
+    return 0;
+}
+
+TEST_CASE("Instances on separate buses stay independent")
+{
+    MockBus bus_a{}, bus_b{};
+    MP2722 pmic_a({bus_write, bus_read, &bus_a, nullptr, nullptr});
+    MP2722 pmic_b({bus_write, bus_read, &bus_b, nullptr, nullptr});
+
+    REQUIRE(pmic_a.init() == MP2722_Result::OK);
+    REQUIRE(pmic_b.init() == MP2722_Result::OK);
+    REQUIRE(pmic_a.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(pmic_b.setChargeCurrent(2000) == MP2722_Result::OK);
+
+    REQUIRE((bus_a.regs[MP2722_REG_CONFIG2] & MP2722_ICC_MASK) == 12);
+    REQUIRE((bus_b.regs[MP2722_REG_CONFIG2] & MP2722_ICC_MASK) == 25);
+}
+
+TEST_CASE("Status reads report INT_LIST change events")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    PowerStatus status{};
+    uint32_t events = 0;
+
+    mock_regs[MP2722_REG_STATUS13] = 0b01100000; // Fast charge
+    REQUIRE(pmic.getStatus(status, events) == MP2722_Result::OK);
+    REQUIRE(events == 0); // First read only sets the baseline
+
+    REQUIRE(pmic.getStatus(status, events) == MP2722_Result::OK);
+    REQUIRE(events == 0);
+
+    mock_regs[MP2722_REG_STATUS11] = 0b10010000; // High-voltage adapter
+    mock_regs[MP2722_REG_STATUS12] = 0b01100000; // VIN_GD, VIN_RDY
+    mock_regs[MP2722_REG_STATUS13] = 0b10100000; // Charge done
+    REQUIRE(pmic.getStatus(status, events) == MP2722_Result::OK);
+    REQUIRE(events == (MP2722_EVT_DPDM_DET_DONE | MP2722_EVT_HVCHARGER | MP2722_EVT_VIN_GD |
+                       MP2722_EVT_VIN_RDY | MP2722_EVT_CHG_DONE));
+
+    mock_regs[MP2722_REG_STATUS12] = 0b00100000; // VIN_GD lost (change), VIN_RDY unchanged
+    mock_regs[MP2722_REG_STATUS13] = 0b01101000; // Recharge (CC), boost OVP
+    REQUIRE(pmic.getStatus(status, events) == MP2722_Result::OK);
+    REQUIRE(events == (MP2722_EVT_VIN_GD | MP2722_EVT_RECHARGE | MP2722_EVT_BOOST_FAULT));
+
+    mock_regs[MP2722_REG_STATUS12] = 0b00000000; // VIN_RDY falling edge raises nothing
+    mock_regs[MP2722_REG_STATUS13] = 0b01100000; // Boost OVP recovered
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(pmic.takeEvents() == MP2722_EVT_BOOST_FAULT);
+    REQUIRE(pmic.takeEvents() == 0);
+}
+
+static void record_events(uint32_t events, const PowerStatus &, void *user)
+{
+    *static_cast<uint32_t *>(user) |= events;
+}
+
+TEST_CASE("Interrupts are serviced with one status read per burst")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    uint32_t events = 0;
+    pmic.setEventCallback(record_events, &events);
+
+    read_count = 0;
+    REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(read_count == 0); // Nothing pending, no bus traffic
+
+    pmic.onInterrupt();
+    REQUIRE(pmic.service() == MP2722_Result::OK); // Baseline read
+    REQUIRE(read_count == 1);
+
+    mock_regs[MP2722_REG_STATUS12] = 0b01000000; // VIN_GD
+    for (int i = 0; i < MP2722_IRQ_QUEUE_SIZE + 3; i++)
+        pmic.onInterrupt(i);
+    REQUIRE(pmic.droppedInterrupts() == 3);
+    REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(read_count == 2);
+    REQUIRE(events == MP2722_EVT_VIN_GD);
+}
+
+TEST_CASE("Interrupts raised during an async operation are serviced after it")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    pending.clear();
+    MP2722 pmic(mock_async_i2c);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    uint32_t events = 0;
+    pmic.setEventCallback(record_events, &events);
+    pmic.onInterrupt();
+    REQUIRE(pmic.service() == MP2722_Result::OK); // Baseline read
+
+    MP2722_Result result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.setChargeCurrentAsync(1000, async_done, &result) == MP2722_Result::OK);
+    mock_regs[MP2722_REG_STATUS12] = 0b01000000; // VIN_GD
+    pmic.onInterrupt();
+    REQUIRE(pmic.service() == MP2722_Result::OK); // Busy: the pulse stays queued
+    REQUIRE(events == 0);
+
+    while (complete_one())
+        REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(result == MP2722_Result::OK);
+    REQUIRE(!pmic.isBusy());
+    REQUIRE(events == MP2722_EVT_VIN_GD);
+}
+
+TEST_CASE("RawStatus accessors match the PowerStatus decode")
+{
+    constexpr RawStatus done = {{0x00, 0x60, 0xA0, 0x00, 0x00, 0x00}};
+    static_assert(done.chargerStatus() == ChargerStatus::CHARGE_DONE, "CHG_STAT");
+    static_assert(done.chargerReady(), "VIN_GD & VIN_RDY");
+    static_assert(sizeof(RawStatus) == MP2722_STATUS_REG_COUNT, "6 bytes per snapshot");
+
+    memset(mock_regs, 0, sizeof(mock_regs));
+    mock_regs[MP2722_REG_STATUS11] = 0x92;
+    mock_regs[MP2722_REG_STATUS12] = 0x6A;
+    mock_regs[MP2722_REG_STATUS13] = 0x6B;
+    mock_regs[MP2722_REG_STATUS14] = 0x8A;
+    mock_regs[MP2722_REG_STATUS15] = 0x96;
+    mock_regs[MP2722_REG_STATUS16] = 0x5B;
+    MP2722 pmic(mock_i2c);
+
+    RawStatus raw;
+    PowerStatus status{};
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    PowerStatus converted = raw.toPowerStatus();
+
+    // Expected values decoded by hand from the register bytes, for both paths
+    for (const PowerStatus &s : {status, converted})
+    {
+        REQUIRE(s.legacy_src_type == LegacyInputSrcType::HIGH_VOLTAGE); // 11h: DPDM_STAT=1001, VINDPM
+        REQUIRE(s.input_dpm_regulation);
+        REQUIRE(s.vin_good); // 12h: VIN_GD, VIN_RDY, THERM_STAT, WATCHDOG_FAULT
+        REQUIRE(s.vin_ready);
+        REQUIRE(s.charger_ready);
+        REQUIRE_FALSE(s.legacy_cable);
+        REQUIRE(s.thermal_regulation);
+        REQUIRE_FALSE(s.vsys_regulation);
+        REQUIRE(s.fault_watchdog);
+        REQUIRE(s.charger_status == ChargerStatus::FAST_CHARGE); // 13h: 011/010/11
+        REQUIRE(s.boost_fault == BoostFault::OVERVOLT);
+        REQUIRE(s.charger_fault == ChargerFault::BATT_OVERVOLT);
+        REQUIRE(s.fault_ntc); // 14h: NTC_MISSING, NTC1=001, NTC2=010
+        REQUIRE_FALSE(s.fault_battery);
+        REQUIRE(s.ntc1_state == NTCState::WARM);
+        REQUIRE(s.ntc2_state == NTCState::COOL);
+        REQUIRE(s.cc1_snk_stat == CCSinkStatus::vRd_1_5A); // 15h: 10/01/01/10
+        REQUIRE(s.cc2_snk_stat == CCSinkStatus::vRd_USB);
+        REQUIRE(s.cc1_src_stat == CCSourceStatus::vRd);
+        REQUIRE(s.cc2_src_stat == CCSourceStatus::vRa);
+        REQUIRE(s.topoff_active); // 16h: TOPOFF_ACTIVE, BATT_LOW_STAT, OTG_NEED, DEBUGACC, AUDIOACC
+        REQUIRE_FALSE(s.bfet_stat);
+        REQUIRE(s.batt_low_stat);
+        REQUIRE(s.otg_need);
+        REQUIRE_FALSE(s.vin_test_high);
+        REQUIRE(s.debug_acc);
+        REQUIRE(s.audio_acc);
+    }
+    REQUIRE(memcmp(raw.regs, &mock_regs[MP2722_REG_STATUS11], MP2722_STATUS_REG_COUNT) == 0);
+}
+
+TEST_CASE("Partial status reads cover only the requested window")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    mock_regs[MP2722_REG_STATUS13] = 0b10100000; // Charge done
+    mock_regs[MP2722_REG_STATUS15] = 0b01000000; // CC1 vRd-USB
+    MP2722 pmic(mock_i2c);
+
+    // Capture the window of each read
+    struct Window
+    {
+        static int read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+        {
+            *static_cast<std::pair<uint8_t, size_t> *>(ctx) = {reg, len};
+            return mock_read(nullptr, addr, reg, data, len);
+        }
+    };
+    std::pair<uint8_t, size_t> window;
+    MP2722 spy({mock_write, Window::read, &window, nullptr, nullptr});
+
+    RawStatus raw{};
+    REQUIRE(spy.getStatus(MP2722_STATUS_CHARGER, raw) == MP2722_Result::OK);
+    REQUIRE(window == std::make_pair((uint8_t)MP2722_REG_STATUS13, (size_t)1));
+    REQUIRE(raw.chargerStatus() == ChargerStatus::CHARGE_DONE);
+    REQUIRE(raw.reg(MP2722_REG_STATUS15) == 0); // Not read
+
+    REQUIRE(spy.getStatus(MP2722_STATUS_CHARGER | MP2722_STATUS_TYPEC, raw) == MP2722_Result::OK);
+    REQUIRE(window == std::make_pair((uint8_t)MP2722_REG_STATUS13, (size_t)3));
+    REQUIRE(raw.cc1SnkStat() == CCSinkStatus::vRd_USB);
+
+    REQUIRE(spy.getStatus(0, raw) == MP2722_Result::INVALID_ARG);
+
+    // Partial reads feed change events once a full baseline exists
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    mock_regs[MP2722_REG_STATUS13] = 0b01100000; // Recharge
+    REQUIRE(pmic.getStatus(MP2722_STATUS_CHARGER, raw) == MP2722_Result::OK);
+    REQUIRE(pmic.takeEvents() == MP2722_EVT_RECHARGE);
+}
+
+static uint32_t fake_time = 0;
+static uint32_t fake_clock()
+{
+    return fake_time;
+}
+
+TEST_CASE("Flight recorder keeps deduplicated history around a fault")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    MP2722_FlightRecorderBuffer<4, 1> recorder;
+    pmic.setClock(fake_clock);
+    pmic.attachRecorder(&recorder);
+    RawStatus raw;
+
+    const uint8_t states[] = {0x60, 0x60, 0x80, 0x80, 0xA0, 0x62, 0x63, 0x64, 0x00}; // CHG_STAT (+CHG_FAULT)
+    for (uint8_t i = 0; i < sizeof(states); i++)
+    {
+        fake_time = 100 * i;
+        mock_regs[MP2722_REG_STATUS13] = states[i];
+        REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    }
+
+    // 6 distinct states, fault at 0x62, one entry kept after it, then frozen
+    REQUIRE(recorder.frozen());
+    REQUIRE(recorder.size() == 4);
+    REQUIRE(recorder.triggerIndex() == 2);
+    REQUIRE(recorder[0].timestamp == 200);
+    REQUIRE(recorder[1].status.chargerStatus() == ChargerStatus::CHARGE_DONE);
+    REQUIRE(recorder[2].status.chargerFault() == ChargerFault::TIMEOUT);
+    REQUIRE(recorder[2].timestamp == 500);
+    REQUIRE(recorder[3].timestamp == 600);
+
+    recorder.rearm();
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(recorder.size() == 1);
+}
+
+TEST_CASE("Scheduler postpones the poll and kick during an async operation")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    pending.clear();
+    MP2722 pmic(mock_async_i2c);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.syncRegisterCache() == MP2722_Result::OK);
+    REQUIRE(pmic.setWatchdog(WatchdogTimer::SEC_40) == MP2722_Result::OK);
+    REQUIRE(pmic.tick(0) == MP2722_Result::OK);
+
+    MP2722_Result result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.setChargeCurrentAsync(1000, async_done, &result) == MP2722_Result::OK);
+    read_count = 0;
+    write_count = 0;
+    uint32_t later = pmic.watchdogPeriodMs(); // Poll and kick both due
+    REQUIRE(pmic.tick(later) == MP2722_Result::OK);
+    REQUIRE(read_count == 0);
+    REQUIRE(write_count == 0);
+
+    while (complete_one())
+        REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(result == MP2722_Result::OK);
+    read_count = 0;
+    write_count = 0;
+    REQUIRE(pmic.tick(later) == MP2722_Result::OK); // Caught up once the bus is free
+    REQUIRE(read_count == 1);
+    REQUIRE(write_count == 1);
+}
+
+TEST_CASE("Poll scheduler adapts to the charger phase")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    REQUIRE(pmic.nextPollDelayMs() == 0); // Never read
+
+    read_count = 0;
+    REQUIRE(pmic.tick(0) == MP2722_Result::OK); // On battery
+    REQUIRE(read_count == 1);
+    REQUIRE(pmic.nextPollDelayMs() == MP2722_POLL_BATTERY_MS);
+    REQUIRE(pmic.tick(MP2722_POLL_BATTERY_MS - 1) == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+    REQUIRE(pmic.tick(MP2722_POLL_BATTERY_MS) == MP2722_Result::OK);
+    REQUIRE(read_count == 2);
+
+    mock_regs[MP2722_REG_STATUS12] = 0b01000000; // VIN_GD, detection in progress
+    RawStatus raw;
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(pmic.nextPollDelayMs() == MP2722_POLL_FAST_MS);
+
+    mock_regs[MP2722_REG_STATUS12] = 0b01100000; // VIN_RDY
+    mock_regs[MP2722_REG_STATUS13] = 0b01100000; // Fast charge
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(pmic.nextPollDelayMs() == MP2722_POLL_FAST_MS); // Two reads in a row with events
+    for (int i = 0; i < MP2722_POLL_MAX_ACTIVITY; i++)
+        REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(pmic.nextPollDelayMs() == MP2722_POLL_CHARGING_MS);
+
+    mock_regs[MP2722_REG_STATUS13] = 0b10100000; // Charge done, activity decays over quiet reads
+    for (int i = 0; i < MP2722_POLL_MAX_ACTIVITY; i++)
+        REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(pmic.nextPollDelayMs() == MP2722_POLL_IDLE_MS);
+
+    mock_regs[MP2722_REG_STATUS12] = 0b01101000; // Thermal regulation
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    for (int i = 0; i < MP2722_POLL_MAX_ACTIVITY; i++)
+        REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(pmic.nextPollDelayMs() == MP2722_POLL_REGULATION_MS);
+}
+
+TEST_CASE("Watchdog kicks are single writes scheduled by tick")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    mock_regs[MP2722_REG_CONFIG7] = 0b00010110; // POR: 40s watchdog, 2x timer, 10h charge timer
+    MP2722 pmic(mock_i2c);
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.watchdogPeriodMs() == 40000);
+
+    read_count = 0;
+    write_count = 0;
+    write_log.clear();
+    REQUIRE(pmic.watchdogKick() == MP2722_Result::OK);
+    REQUIRE(read_count == 0);
+    REQUIRE(write_count == 1);
+    REQUIRE(write_log.size() == 1);
+    REQUIRE(write_log[0].first == MP2722_REG_CONFIG7);
+    REQUIRE(write_log[0].second == (0b00010110 | MP2722_WATCHDOG_RST_MASK));
+
+    // Without the cache CONFIG7h is read back first, the copy init() loaded may be stale
+    pmic.setRegisterCache(false);
+    mock_regs[MP2722_REG_CONFIG7] = 0b00100110; // Changed behind the driver: 80s watchdog
+    write_log.clear();
+    REQUIRE(pmic.watchdogKick() == MP2722_Result::OK);
+    REQUIRE(write_log.back().second == (0b00100110 | MP2722_WATCHDOG_RST_MASK));
+    REQUIRE(pmic.watchdogPeriodMs() == 40000); // The copy read for the kick is not trusted uncached either
+    mock_regs[MP2722_REG_CONFIG7] = 0b00010110;
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.syncRegisterCache() == MP2722_Result::OK);
+
+    // Configuration writes covering CONFIG7h carry a kick too
+    write_log.clear();
+    REQUIRE(pmic.setChargeTimer(ChargeTimer::HOURS_5, false) == MP2722_Result::OK);
+    REQUIRE(write_log.back().second == (0b00010001 | MP2722_WATCHDOG_RST_MASK));
+
+    REQUIRE(pmic.setWatchdog(WatchdogTimer::SEC_80) == MP2722_Result::OK);
+    REQUIRE(pmic.watchdogPeriodMs() == 80000);
+    REQUIRE(pmic.setWatchdog(WatchdogTimer::SEC_40) == MP2722_Result::OK);
+
+    // On battery (10s polls): kicked on the poll tick at the 20s half period
+    write_count = 0;
+    REQUIRE(pmic.tick(0) == MP2722_Result::OK);
+    REQUIRE(write_count == 0);
+    REQUIRE(pmic.tick(MP2722_POLL_BATTERY_MS) == MP2722_Result::OK);
+    REQUIRE(write_count == 0);
+    REQUIRE(pmic.tick(2 * MP2722_POLL_BATTERY_MS) == MP2722_Result::OK);
+    REQUIRE(write_count == 1);
+    REQUIRE(pmic.tick(3 * MP2722_POLL_BATTERY_MS) == MP2722_Result::OK);
+    REQUIRE(write_count == 1);
+
+    REQUIRE(pmic.setWatchdog(WatchdogTimer::DISABLED) == MP2722_Result::OK);
+    REQUIRE(pmic.watchdogPeriodMs() == 0);
+    write_count = 0;
+    REQUIRE(pmic.tick(10 * MP2722_POLL_BATTERY_MS) == MP2722_Result::OK);
+    REQUIRE(write_count == 0);
+}
+
+static std::vector<std::string> log_lines;
+
+static void capture_log(MP2722_LogLevel level, const char *message)
+{
+    (void)level;
+    log_lines.push_back(message);
+}
+
+TEST_CASE("Log records are formatted from their raw arguments")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    pmic.setLogCallback(MP2722_LogLevel::DEBUG, capture_log);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+
+    log_lines.clear();
+    REQUIRE(pmic.setChargeCurrent(960) == MP2722_Result::OK);
+    REQUIRE(pmic.flushLog() == 0); // Formatted in place without MP2722_LOG_DEFER_SIZE
+    REQUIRE(log_lines.size() == 1);
+    REQUIRE(log_lines[0].rfind("Set Charge Current: 960mA (0x0C)", 0) == 0);
+
+    // Per-poll register dumps are DEBUG only
+    pmic.setLogCallback(MP2722_LogLevel::INFO, capture_log);
+    log_lines.clear();
+    PowerStatus status;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(log_lines.empty());
+}
+
+struct CountingLock
+{
+    int depth = 0;
+    int acquired = 0;
+};
+
+static void counting_lock(void *ctx)
+{
+    CountingLock *l = static_cast<CountingLock *>(ctx);
+    l->depth++;
+    l->acquired++;
+}
+
+static void counting_unlock(void *ctx)
+{
+    static_cast<CountingLock *>(ctx)->depth--;
+}
+
+static CountingLock bus_lock;
+static int unlocked_transfers = 0;
+
+static int locked_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *data, size_t len)
+{
+    unlocked_transfers += (bus_lock.depth == 0);
+    return mock_write(ctx, addr, reg, data, len);
+}
+
+static int locked_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *data, size_t len)
+{
+    unlocked_transfers += (bus_lock.depth == 0);
+    return mock_read(ctx, addr, reg, data, len);
+}
+
+TEST_CASE("Public calls hold the driver lock and the bus lock")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722_I2C i2c = {locked_write, locked_read, nullptr, nullptr, nullptr};
+    MP2722 pmic(i2c);
+    CountingLock api_lock;
+    bus_lock = CountingLock();
+    pmic.setLock({counting_lock, counting_unlock, &api_lock});
+    pmic.setBusLock({counting_lock, counting_unlock, &bus_lock});
+
+    unlocked_transfers = 0;
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setInputCurrentLimit(1500) == MP2722_Result::OK); // Read-modify-write of CONFIG1h
+    PowerStatus status;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(pmic.tick(0) == MP2722_Result::OK); // Nests getStatus() and watchdogKick()
+    REQUIRE(unlocked_transfers == 0);
+    REQUIRE(api_lock.depth == 0);
+    REQUIRE(bus_lock.depth == 0);
+    REQUIRE(api_lock.acquired > 0);
+
+    // Without locks the driver behaves as before
+    pmic.setLock({});
+    pmic.setBusLock({});
+    int acquired = api_lock.acquired;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(api_lock.acquired == acquired);
+    REQUIRE(unlocked_transfers == 1);
+}
+
+TEST_CASE("Status readers within the max age share the published snapshot")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    MP2722 pmic(mock_i2c);
+    pmic.setClock(fake_clock);
+    pmic.setStatusMaxAge(50);
+    RawStatus raw;
+    REQUIRE_FALSE(pmic.peekStatus(raw));
+
+    fake_time = 1000;
+    mock_regs[MP2722_REG_STATUS13] = 0b01100000; // Fast charge
+    read_count = 0;
+    PowerStatus status;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+
+    // Other readers within 50ms: no bus access, even if the PMIC changed meanwhile
+    mock_regs[MP2722_REG_STATUS13] = 0b10100000;
+    fake_time = 1050;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(pmic.getStatus(MP2722_STATUS_CHARGER, raw) == MP2722_Result::OK);
+    REQUIRE(read_count == 1);
+    REQUIRE(status.charger_status == ChargerStatus::FAST_CHARGE);
+    uint32_t age;
+    REQUIRE(pmic.peekStatus(raw, &age));
+    REQUIRE(age == 50);
+
+    // Expired snapshot, and the events variant, always read the bus
+    fake_time = 1051;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+    REQUIRE(read_count == 2);
+    REQUIRE(status.charger_status == ChargerStatus::CHARGE_DONE);
+    uint32_t events;
+    REQUIRE(pmic.getStatus(status, events) == MP2722_Result::OK);
+    REQUIRE(read_count == 3);
+
+    // A partial read publishes nothing, the rest of the registers would be stale
+    fake_time = 2000;
+    mock_regs[MP2722_REG_STATUS12] = 0b01100000; // VIN_RDY, outside the window
+    REQUIRE(pmic.getStatus(MP2722_STATUS_CHARGER, raw) == MP2722_Result::OK);
+    REQUIRE(read_count == 4);
+    REQUIRE(pmic.peekStatus(raw, &age));
+    REQUIRE(age == 2000 - 1051);
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(read_count == 5);
+    REQUIRE(raw.regs[MP2722_REG_STATUS12 - MP2722_REG_STATUS11] == 0b01100000);
+}
+
+TEST_CASE("Simulator models the register map rules")
+{
+    MP2722Sim sim;
+    REQUIRE(sim.loaded());
+    REQUIRE(sim.reg(MP2722_REG_CONFIG0) == 0b00001011);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG7) == 0b00011110);
+    REQUIRE(sim.watchdogResetMask(MP2722_REG_CONFIG2) == MP2722_ICC_MASK);
+
+    MP2722_I2C bus = sim.i2c();
+    uint8_t val = 0xFF;
+    REQUIRE(bus.write(bus.ctx, MP2722_I2C_ADDRESS, MP2722_REG_STATUS13, &val, 1) == 0);
+    REQUIRE(sim.reg(MP2722_REG_STATUS13) == 0); // Read-only
+    REQUIRE(bus.write(bus.ctx, MP2722_I2C_ADDRESS, MP2722_REG_CONFIG10, &val, 1) == 0);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG10) == 0b01111111); // Bit 7 reserved, read-only
+
+    // LOCK_CHG: ICC may go down, not up
+    val = sim.reg(MP2722_REG_CONFIG0) | MP2722_LOCK_CHG_MASK;
+    REQUIRE(bus.write(bus.ctx, MP2722_I2C_ADDRESS, MP2722_REG_CONFIG0, &val, 1) == 0);
+    val = 0x05;
+    REQUIRE(bus.write(bus.ctx, MP2722_I2C_ADDRESS, MP2722_REG_CONFIG2, &val, 1) == 0);
+    REQUIRE((sim.reg(MP2722_REG_CONFIG2) & MP2722_ICC_MASK) == 0x05);
+    val = 0x20;
+    REQUIRE(bus.write(bus.ctx, MP2722_I2C_ADDRESS, MP2722_REG_CONFIG2, &val, 1) == 0);
+    REQUIRE((sim.reg(MP2722_REG_CONFIG2) & MP2722_ICC_MASK) == 0x05);
+
+    // REG_RST restores POR values and clears itself
+    val = MP2722_REG_RST_MASK;
+    REQUIRE(bus.write(bus.ctx, MP2722_I2C_ADDRESS, MP2722_REG_CONFIG0, &val, 1) == 0);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG0) == sim.porValue(MP2722_REG_CONFIG0));
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == sim.porValue(MP2722_REG_CONFIG2));
+
+    // Scripted status evolution pulses INT
+    const MP2722Sim::Step steps[] = {
+        {100, MP2722_REG_STATUS12, 0b01000000},
+        {300, MP2722_REG_STATUS12, 0b01100000},
+    };
+    sim.script(steps, 2);
+    sim.intPulses = 0;
+    sim.advance(200);
+    REQUIRE(sim.reg(MP2722_REG_STATUS12) == 0b01000000);
+    sim.advance(200);
+    REQUIRE(sim.reg(MP2722_REG_STATUS12) == 0b01100000);
+    REQUIRE(sim.intPulses == 2);
+}
+
+static void sim_interrupt(void *user)
+{
+    static_cast<MP2722 *>(user)->onInterrupt();
+}
+
+TEST_CASE("Driver resynchronizes after a simulated watchdog expiry")
+{
+    MP2722Sim sim;
+    MP2722 pmic(sim.i2c());
+    pmic.setRegisterCache(true);
+    sim.setIntCallback(sim_interrupt, &pmic);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    uint8_t icc = sim.reg(MP2722_REG_CONFIG2);
+    REQUIRE(icc != sim.porValue(MP2722_REG_CONFIG2));
+
+    // tick() keeps the watchdog fed
+    for (int i = 0; i < 200; i++)
+    {
+        sim.advance(1000);
+        REQUIRE(pmic.tick(sim.now()) == MP2722_Result::OK);
+    }
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == icc);
+    REQUIRE((sim.reg(MP2722_REG_STATUS12) & MP2722_WATCHDOG_FAULT_MASK) == 0);
+
+    // Starved: WTD fields go back to POR, the INT pulse makes service() read the fault
+    sim.advance(40000);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == sim.porValue(MP2722_REG_CONFIG2));
+    uint32_t events = 0;
+    pmic.setEventCallback(record_events, &events);
+    REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE((events & MP2722_EVT_WATCHDOG_FAULT) != 0);
+
+    // The same read restored the configuration, so the cache holds again
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == icc);
+    sim.reads = 0;
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(sim.reads == 0);
+}
+
+TEST_CASE("Watchdog expiry is recovered with one burst write")
+{
+    MP2722Sim sim;
+    MP2722 pmic(sim.i2c());
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeVoltage(4350) == MP2722_Result::OK);
+    REQUIRE(pmic.setWatchdog(WatchdogTimer::SEC_80) == MP2722_Result::OK);
+    REQUIRE(pmic.setCharging(true) == MP2722_Result::OK);
+    uint8_t applied[MP2722_CONFIG_REG_COUNT];
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+        applied[reg] = sim.reg(reg);
+
+    sim.advance(80000);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == sim.porValue(MP2722_REG_CONFIG2));
+    REQUIRE(sim.reg(MP2722_REG_CONFIG7) != applied[MP2722_REG_CONFIG7]);
+
+    // Any status read covering REG12h notices the fault and restores CONFIG00h~0Fh in the same call
+    MP2722_BusStats stats = {};
+    pmic.attachBusStats(&stats);
+    RawStatus raw;
+    REQUIRE(pmic.getStatus(MP2722_STATUS_POWER, raw) == MP2722_Result::OK);
+    REQUIRE(raw.faultWatchdog());
+    REQUIRE(stats.write.count == 1);
+    REQUIRE(stats.write.bytes == MP2722_CONFIG_REG_COUNT - 1);
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+        REQUIRE(sim.reg(reg) == applied[reg]);
+    REQUIRE((sim.reg(MP2722_REG_STATUS12) & MP2722_WATCHDOG_FAULT_MASK) == 0); // Kicked by the restore
+
+    PowerStatus status;
+    uint32_t events;
+    REQUIRE(pmic.getStatus(status, events) == MP2722_Result::OK);
+    REQUIRE((events & MP2722_EVT_CONFIG_RESTORED) != 0);
+    REQUIRE(stats.write.count == 1);
+}
+
+TEST_CASE("A failed watchdog recovery refuses charging and is retried")
+{
+    MP2722Sim sim;
+    FaultBus bus(sim.i2c());
+    MP2722 pmic(bus.i2c());
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeVoltage(4350) == MP2722_Result::OK);
+    REQUIRE(pmic.setCharging(true) == MP2722_Result::OK);
+    uint8_t icc = sim.reg(MP2722_REG_CONFIG2);
+
+    sim.advance(40000);
+    bus.inject({2, 0, 0, 0, 0}); // The status read goes through, the restore write NAKs
+    RawStatus raw;
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(raw.faultWatchdog());
+    REQUIRE(bus.naks == 1);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == sim.porValue(MP2722_REG_CONFIG2));
+
+    bus.inject({0, 0, 0, 0, 0});
+    REQUIRE(pmic.setCharging(true) == MP2722_Result::INVALID_STATE);
+    uint32_t events = 0;
+    pmic.setEventCallback(record_events, &events);
+    REQUIRE(pmic.tick(sim.now()) == MP2722_Result::OK);
+    REQUIRE((events & MP2722_EVT_CONFIG_RESTORED) != 0);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == icc);
+
+    // The cache was whole before the fault, so it is trusted again without a reload
+    MP2722_BusStats stats = {};
+    pmic.attachBusStats(&stats);
+    REQUIRE(pmic.setCharging(true) == MP2722_Result::OK);
+    REQUIRE(pmic.setAutoOTG(false) == MP2722_Result::OK);
+    REQUIRE(stats.read.count == 0);
+}
+
+TEST_CASE("Watchdog recovery sets LOCK_CHG after the restored setpoints")
+{
+    using namespace MP2722_Fields;
+    MP2722Sim sim;
+    MP2722 pmic(sim.i2c());
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    static constexpr MP2722_Config locked = MP2722_Config::porDefaults().set<ICC>(3000).set<LOCK_CHG>(true);
+    REQUIRE(pmic.applyConfig(locked) == MP2722_Result::OK);
+
+    // LOCK_CHG is no watchdog-reset field: the PMIC stays locked with the POR charge current
+    sim.advance(40000);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == sim.porValue(MP2722_REG_CONFIG2));
+    REQUIRE(sim.reg(MP2722_REG_CONFIG0) & MP2722_LOCK_CHG_MASK);
+
+    RawStatus raw;
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(raw.faultWatchdog());
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == locked.reg(MP2722_REG_CONFIG2));
+    REQUIRE(sim.reg(MP2722_REG_CONFIG0) & MP2722_LOCK_CHG_MASK);
+}
+
+TEST_CASE("A watchdog fault first seen by a partial read is handled once")
+{
+    MP2722Sim sim;
+    FaultBus bus(sim.i2c());
+    MP2722 pmic(bus.i2c());
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeVoltage(4350) == MP2722_Result::OK);
+    uint8_t icc = sim.reg(MP2722_REG_CONFIG2);
+
+    // No full status read yet, and the restore NAKs: the fault is still latched on the next read
+    sim.advance(40000);
+    bus.inject({2, 0, 0, 0, 0});
+    RawStatus raw;
+    REQUIRE(pmic.getStatus(MP2722_STATUS_POWER, raw) == MP2722_Result::OK);
+    REQUIRE(raw.faultWatchdog());
+    REQUIRE(bus.naks == 1);
+
+    bus.inject({0, 0, 0, 0, 0});
+    REQUIRE(pmic.getStatus(raw) == MP2722_Result::OK);
+    REQUIRE(raw.faultWatchdog());
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == icc);
+
+    // Same fault, not a new one: the cache was whole before it and is trusted again
+    MP2722_BusStats stats = {};
+    pmic.attachBusStats(&stats);
+    REQUIRE(pmic.setCharging(true) == MP2722_Result::OK);
+    REQUIRE(stats.read.count == 0);
+}
+
+TEST_CASE("Async status reads restore the configuration after a watchdog fault")
+{
+    memset(mock_regs, 0, sizeof(mock_regs));
+    pending.clear();
+    MP2722 pmic(mock_async_i2c);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    uint8_t icc = mock_regs[MP2722_REG_CONFIG2];
+    mock_regs[MP2722_REG_CONFIG2] = 0xD9; // Back to POR
+    mock_regs[MP2722_REG_STATUS12] = MP2722_WATCHDOG_FAULT_MASK;
+
+    PowerStatus status{};
+    MP2722_Result result = MP2722_Result::NOT_FOUND;
+    REQUIRE(pmic.getStatusAsync(status, async_done, &result) == MP2722_Result::OK);
+    REQUIRE(complete_one());
+    REQUIRE(pmic.service() == MP2722_Result::OK);
+    REQUIRE(result == MP2722_Result::OK);
+    REQUIRE(status.fault_watchdog);
+    REQUIRE(mock_regs[MP2722_REG_CONFIG2] == icc);
+    REQUIRE((pmic.takeEvents() & MP2722_EVT_CONFIG_RESTORED) != 0);
+}
+
+static uint32_t step_time = 0;
+static uint32_t step_timer()
+{
+    return step_time += 3; // Every transfer appears to take 3 ticks
+}
+
+TEST_CASE("Bus statistics count transfers, avoided writes and latency")
+{
+    MP2722Sim sim;
+    MP2722 pmic(sim.i2c());
+    pmic.setRegisterCache(true);
+    REQUIRE(pmic.getBusStats() == nullptr);
+
+    MP2722_BusStats stats = {};
+    pmic.attachBusStats(&stats, step_timer);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(stats.read.count == 1);
+    REQUIRE(stats.read.bytes == MP2722_CONFIG_REG_COUNT);
+    REQUIRE(stats.write.count == sim.writes);
+
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    uint32_t avoided = stats.writesAvoided;
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    REQUIRE(stats.writesAvoided == avoided + 1);
+
+    sim.failNext(1);
+    PowerStatus status;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::FAIL);
+    REQUIRE(stats.read.failures == 1);
+    REQUIRE(stats.read.lastError == -1);
+    REQUIRE(stats.read.count == 2);
+    REQUIRE(stats.read.bytes == MP2722_CONFIG_REG_COUNT); // Failed transfers move no data
+
+    REQUIRE(MP2722_BusOpStats::bucket(0) == 0);
+    REQUIRE(MP2722_BusOpStats::bucket(1) == 1);
+    REQUIRE(MP2722_BusOpStats::bucket(3) == 2);
+    REQUIRE(MP2722_BusOpStats::bucket(0xFFFFFFFF) == MP2722_LATENCY_BUCKETS - 1);
+    REQUIRE(stats.read.latency[2] == stats.read.count);
+    REQUIRE(stats.write.latency[2] == stats.write.count);
+    REQUIRE(stats.read.maxLatency == 3);
+
+    pmic.resetBusStats();
+    REQUIRE(stats.read.count == 0);
+    REQUIRE(stats.writesAvoided == 0);
+}
+
+TEST_CASE("Retries recover idempotent transfers and never repeat action bits")
+{
+    MP2722Sim sim;
+    FaultBus bus(sim.i2c());
+    MP2722 pmic(bus.i2c());
+    pmic.setRegisterCache(true);
+    MP2722_BusStats stats = {};
+    pmic.attachBusStats(&stats);
+
+    bus.inject({2, 0, 0, 0, 0}); // Every other transfer NAKs
+    REQUIRE(pmic.init() == MP2722_Result::FAIL);
+    REQUIRE(stats.retries == 0);
+
+    pmic.setRetryPolicy({3, 1, 4, 10, FaultBus::delay});
+    bus.inject({2, 0, 0, 0, 0});
+    uint32_t start = FaultBus::micros();
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(stats.retries > 0);
+    REQUIRE(FaultBus::micros() - start >= stats.retries * 1000); // Waited 1 ms before each retry
+
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+
+    // A dead bus: reads use every attempt, a REG_RST write gets exactly one
+    bus.inject({1, 0, 0, 0, 0});
+    PowerStatus status;
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::FAIL);
+    REQUIRE(bus.transfers == 3);
+
+    bus.inject({1, 0, 0, 0, 0});
+    REQUIRE(pmic.reset() == MP2722_Result::FAIL);
+    REQUIRE(bus.transfers == 1);
+
+    // The time budget stops retrying before the attempts run out
+    pmic.setRetryPolicy({10, 2, 8, 5, FaultBus::delay});
+    pmic.setClock(FaultBus::millis);
+    bus.inject({1, 0, 0, 0, 0});
+    REQUIRE(pmic.getStatus(status) == MP2722_Result::FAIL);
+    REQUIRE(bus.transfers == 2); // 2 ms, then 4 ms would end past 5 ms
+}
+
+TEST_CASE("Tail latency under NAKs, latency spikes and bit flips stays within the retry budget")
+{
+    MP2722Sim sim;
+    FaultBus bus(sim.i2c(), 100);
+    MP2722 pmic(bus.i2c());
+    MP2722_BusStats stats = {};
+    pmic.attachBusStats(&stats, FaultBus::micros);
+    pmic.setClock(FaultBus::millis);
+    const MP2722_RetryPolicy policy = {4, 1, 4, 8, FaultBus::delay};
+    pmic.setRetryPolicy(policy);
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+
+    const uint32_t spike_us = 3000;
+    bus.inject({7, 13, spike_us, 11, 6});
+    std::vector<uint32_t> latency;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint32_t start = FaultBus::micros();
+        PowerStatus status;
+        REQUIRE(pmic.getStatus(status) == MP2722_Result::OK);
+        latency.push_back(FaultBus::micros() - start);
+    }
+    REQUIRE(bus.naks > 0);
+    REQUIRE(bus.spikes > 0);
+    REQUIRE(bus.flips > 0); // Undetectable at this layer: no effect on timing or results
+    REQUIRE(stats.retries == bus.naks);
+
+    std::sort(latency.begin(), latency.end());
+    uint32_t p50 = latency[latency.size() / 2];
+    uint32_t p99 = latency[latency.size() * 99 / 100];
+    uint32_t max = latency.back();
+    INFO("p50 " << p50 << " us, p99 " << p99 << " us, max " << max << " us");
+    REQUIRE(p50 == 100);
+    REQUIRE(p99 <= 100 + spike_us + 1000 + 100); // Spike, one retry
+    // Last attempt starts within the budget (+1 ms clock resolution) and may itself spike
+    REQUIRE(max <= (policy.budget_ms + 1) * 1000 + 100 + spike_us);
+    REQUIRE(stats.read.maxLatency == 100 + spike_us);
+}
+
+TEST_CASE("Configuration profiles are built at compile time and applied in one burst")
+{
+    using namespace MP2722_Fields;
+    static constexpr MP2722_Config profile = MP2722_Config::porDefaults()
+                                                 .set<ICC>(1000)
+                                                 .set<VBATT_REG>(4350)
+                                                 .set<IPRE>(160)
+                                                 .set<ITERM>(60)
+                                                 .set<VIN_LIM>(4600)
+                                                 .set<SYS_MIN>(3)
+                                                 .set<TREG>(100)
+                                                 .set<VBOOST>(2)
+                                                 .set<CC_CFG>(1)
+                                                 .set<JEITA_ISET>(1)
+                                                 .set<MASK_DPM>(true)
+                                                 .set<EN_CHG>(false);
+    static_assert(profile.get<ICC>() == 960, "Rounded down to the 80mA step");
+    static_assert(profile.get<VBATT_REG>() == 4350, "");
+    static_assert(profile.get<TREG>() == 100, "");
+    static_assert(!profile.get<EN_CHG>(), "");
+    static_assert(profile.reg(MP2722_REG_CONFIG3) == (IPRE::encode(160) | ITERM::encode(60)), "");
+
+    MP2722Sim sim;
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+        REQUIRE(MP2722_Config::porDefaults().reg(reg) == sim.porValue(reg));
+
+    uint16_t too_high = 9000;
+    REQUIRE(MP2722_Config::porDefaults().set<ICC>(too_high).get<ICC>() == ICC::decode(ICC::encode(ICC::max))); // Clamped at runtime
+
+    MP2722 pmic(sim.i2c());
+    REQUIRE(pmic.applyConfig(profile) == MP2722_Result::OK);
+    REQUIRE(sim.writes == 1);
+    REQUIRE(sim.bytesWritten == MP2722_CONFIG_REG_COUNT);
+    REQUIRE(sim.reads == 0);
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+        REQUIRE(sim.reg(reg) == profile.reg(reg));
+
+    REQUIRE(pmic.applyConfig(profile, true) == MP2722_Result::OK);
+    REQUIRE(sim.writes == 2);
+    REQUIRE(sim.reads == 1);
+
+    // The charge lock goes last, so a locked profile may still raise the charge current
+    sim.powerOnReset();
+    sim.writes = 0;
+    static constexpr MP2722_Config locked = profile.set<ICC>(3000).set<LOCK_CHG>(true);
+    REQUIRE(pmic.applyConfig(locked, true) == MP2722_Result::OK);
+    REQUIRE(sim.writes == 2);
+    REQUIRE(sim.reg(MP2722_REG_CONFIG2) == locked.reg(MP2722_REG_CONFIG2));
+    REQUIRE(sim.reg(MP2722_REG_CONFIG0) & MP2722_LOCK_CHG_MASK);
+
+    // A register that does not read back as written fails verification
+    FaultBus bus(sim.i2c());
+    MP2722 flaky(bus.i2c());
+    bus.inject({0, 0, 0, 2, 6}); // The read-back returns EN_STAT_IB flipped
+    REQUIRE(flaky.applyConfig(profile, true) == MP2722_Result::FAIL);
+}
+
+static void collect_fields(const char *name, uint8_t reg, uint8_t from, uint8_t to, void *user)
+{
+    (void)reg;
+    std::string &out = *static_cast<std::string *>(user);
+    out += std::string(name) + ":" + std::to_string(from) + "->" + std::to_string(to) + " ";
+}
+
+TEST_CASE("Register dumps are one burst, restore only what differs and diff by field name")
+{
+    MP2722Sim sim;
+    MP2722 pmic(sim.i2c());
+    REQUIRE(pmic.init() == MP2722_Result::OK);
+    REQUIRE(pmic.setChargeCurrent(1000) == MP2722_Result::OK);
+    sim.setStatus(MP2722_REG_STATUS13, 0x60); // Fast charge
+
+    sim.reads = 0;
+    sim.bytesRead = 0;
+    MP2722_RegisterDump before;
+    REQUIRE(pmic.dumpRegisters(before) == MP2722_Result::OK);
+    REQUIRE(sim.reads == 1);
+    REQUIRE(sim.bytesRead == MP2722_REG_COUNT);
+    for (uint8_t reg = 0; reg < MP2722_REG_COUNT; reg++)
+        REQUIRE(before.reg(reg) == sim.reg(reg));
+    REQUIRE(before.status().chargerStatus() == ChargerStatus::FAST_CHARGE);
+
+    REQUIRE(pmic.setChargeCurrent(2000) == MP2722_Result::OK);
+    REQUIRE(pmic.setAutoOTG(false) == MP2722_Result::OK);
+    sim.setStatus(MP2722_REG_STATUS13, 0x00);
+    MP2722_RegisterDump after;
+    REQUIRE(pmic.dumpRegisters(after) == MP2722_Result::OK);
+
+    std::string changes;
+    REQUIRE(before.diff(after, collect_fields, &changes) == 3);
+    REQUIRE(changes == "ICC:12->25 AUTOOTG:1->0 CHG_STAT:3->0 ");
+    REQUIRE(before.diff(before) == 0);
+
+    // CONFIG02h and CONFIG09h are the only bytes to write back: one read of the bases, two writes
+    sim.reads = 0;
+    sim.writes = 0;
+    sim.bytesWritten = 0;
+    REQUIRE(pmic.restoreConfig(before) == MP2722_Result::OK);
+    REQUIRE(sim.reads == 1);
+    REQUIRE(sim.writes == 2);
+    REQUIRE(sim.bytesWritten == 2);
+    for (uint8_t reg = 0; reg < MP2722_CONFIG_REG_COUNT; reg++)
+        REQUIRE(sim.reg(reg) == before.reg(reg));
+
+    sim.writes = 0;
+    REQUIRE(pmic.restoreConfig(before) == MP2722_Result::OK);
+    REQUIRE(sim.writes == 0);
+}
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Generate src/MP2722_regmap.h from docs/REG_MAP_CONFIG.csv and docs/REG_MAP_STATUS.csv.
+
+Usage: python3 tools/gen_regmap.py  (from anywhere; paths are relative to the repository root)
+"""
+
+import csv
+import os
+import re
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+CONFIG_CSV = os.path.join(ROOT, "docs", "REG_MAP_CONFIG.csv")
+STATUS_CSV = os.path.join(ROOT, "docs", "REG_MAP_STATUS.csv")
+OUTPUT = os.path.join(ROOT, "src", "MP2722_regmap.h")
+
+CONFIG_REG_COUNT = 17
+REG_COUNT = 23
+
+
+def parse(path, por_col, wtd_col, type_col):
+    """Bit rows follow their "REGxxh" row. Returns {reg: [(bit, name, por, wtd, writable)]}."""
+    regs = {}
+    reg = None
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            if not row or row[0].startswith("#"):
+                continue
+            row = [c.strip() for c in row]
+            if row[0].startswith("REG"):
+                reg = int(row[0][3:5], 16)
+                regs[reg] = []
+                continue
+            if reg is None or not row[0].isdigit():
+                continue
+            bit = int(row[0])
+            por = row[por_col] == "1"
+            wtd = wtd_col is not None and row[wtd_col] == "Yes"
+            writable = row[type_col].startswith("R/W")
+            regs[reg].append((bit, row[1], por, wtd, writable))
+    return regs
+
+
+def main():
+    regs = parse(CONFIG_CSV, 2, 3, 4)
+    regs.update(parse(STATUS_CSV, 2, None, 3))
+    assert sorted(regs) == list(range(REG_COUNT)), "Registers 00h~16h expected"
+
+    por = [0] * CONFIG_REG_COUNT
+    wtd = [0] * CONFIG_REG_COUNT
+    writable = [0] * REG_COUNT
+    fields = []  # (name, reg, mask, shift) in register then bit order
+    for reg in range(REG_COUNT):
+        masks = {}
+        for bit, name, is_por, is_wtd, is_writable in regs[reg]:
+            if reg < CONFIG_REG_COUNT:
+                por[reg] |= is_por << bit
+                wtd[reg] |= is_wtd << bit
+            writable[reg] |= is_writable << bit
+            name = re.sub(r"\[\d+\]$", "", name)
+            if name.upper() == "RESERVED":
+                continue
+            if name not in masks:
+                masks[name] = 0
+                fields.append(name)
+            masks[name] |= 1 << bit
+        for name in [n for n in fields if n in masks]:
+            mask = masks[name]
+            shift = (mask & -mask).bit_length() - 1
+            fields[fields.index(name)] = (name, reg, mask, shift)
+
+    def values(table):
+        return ", ".join("0x%02X" % v for v in table)
+
+    lines = [
+        "// Generated from docs/REG_MAP_CONFIG.csv and docs/REG_MAP_STATUS.csv by tools/gen_regmap.py. Do not edit.",
+        "#pragma once",
+        "",
+        '#include "MP2722_regs.h"',
+        "",
+        "// Power-on values of CONFIG00h~10h",
+        "#define MP2722_POR_VALUES %s" % values(por),
+        "",
+        "// Bits reset to their POR value by a watchdog expiry (WTD Reset: Yes), CONFIG00h~10h",
+        "#define MP2722_WTD_RESET_BITS %s" % values(wtd),
+        "",
+        "// Host-writable bits (R/W), REG00h~16h",
+        "#define MP2722_WRITABLE_BITS %s" % values(writable),
+        "",
+        "// Every named field as X(name, register, mask, shift), register then bit order (reserved bits left out)",
+        "#define MP2722_REG_FIELD_LIST(X) \\",
+    ]
+    for name, reg, mask, shift in fields:
+        lines.append("    X(%s, 0x%02X, 0x%02X, %d) \\" % (name, reg, mask, shift))
+    lines[-1] = lines[-1][:-2]
+    lines.append("")
+
+    with open(OUTPUT, "w", newline="\n") as f:
+        f.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()